@@ -0,0 +1,3130 @@
+// Solvers of the rummikub library : tile bitboards, the A* and exact solvers, the run table and the solve cache
+#include "rummikub.h"
+
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <limits.h>
+#include <float.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#if defined(RUMMIKUB_STATS) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#define COLOR_LANE_MASK 0x1FFFULL
+// One bit per color lane, multiply by a lane bit to get the same number in every color
+#define NUMBER_COLUMN 0x0001000100010001ULL
+// Number of orders of the colors, the rules do not depend on the colors order
+#define NB_COLOR_PERMUTATIONS 24
+// Maximum number of table tiles that can complete an illegal set
+#define MAX_EXTENSION_TILES (1 + NB_COLORS)
+// Maximum number of moves on an illegal set : each of its tiles to each set, each extension tile from each set, a split
+#define MAX_TABLE_MOVES (NB_COLORS * NB_NUMBERS * MAX_TABLE_SETS + 2 * MAX_EXTENSION_TILES * MAX_TABLE_SETS + 1)
+// Cost of the most expensive move
+#define MAX_MOVE_COST 2
+// A search with a deadline reads the clock once every DEADLINE_CHECK_NODES expanded nodes
+#define DEADLINE_CHECK_NODES 256
+// A search node stores its whole table when more sets changed or when its chain of bases is longer
+#define MAX_NODE_CHANGED_SETS 4
+#define MAX_NODE_CHAIN_LENGTH 8
+// Maximum number of melds containing a tile (46 runs through a 7 and 4 groups)
+#define MAX_TILE_MELDS 50
+// The exact solver state is the pair of run lengths (0, 1, 2 or 3 and more) of the two copies of each color
+#define DP_RUN_STATES 10
+#define DP_STATES (DP_RUN_STATES * DP_RUN_STATES * DP_RUN_STATES * DP_RUN_STATES)
+#define DP_UNKNOWN INT16_MIN
+#define DP_INFEASIBLE (INT16_MIN + 1)
+// The solve cache file holds at most its size bound, entries are grouped in buckets of SOLVE_CACHE_WAYS
+#define SOLVE_CACHE_MAGIC "RKSCACHE"
+#define SOLVE_CACHE_VERSION 1
+#define SOLVE_CACHE_WAYS 4
+// The run table holds one byte per count (0, 1 or 2) of each of the 13 numbers of a color
+#define RUN_TABLE_MAGIC "RKRUNTBL"
+#define RUN_TABLE_VERSION 1
+#define NB_RUN_CONFIGS 1594323
+// The transposition table has 2^TRANSPOSITION_TABLE_BITS entries grouped in buckets
+#define TRANSPOSITION_TABLE_BITS 16
+#define TRANSPOSITION_BUCKET_SIZE 4
+#define ZOBRIST_SEED 0x5D1CE2A6F3B7C049ULL
+// Size of the blocks allocated by the arenas
+#define ARENA_BLOCK_SIZE (256 * 1024)
+
+// Table state already reached by a search with its shortest path length
+struct TranspositionEntry_s{
+    uint64_t hash;
+    struct PriorityQueue_s* node;
+    int g;
+    unsigned int generation;
+};
+
+// Fixed size transposition table, entries of an older generation are free
+struct TranspositionTable_s{
+    struct TranspositionEntry_s* entries;
+    uint64_t mask;
+    unsigned int generation;
+};
+
+// Memory block of an arena, blocks are kept when the arena is reset to be filled again
+struct ArenaBlock_s{
+    struct ArenaBlock_s* next_block;
+    size_t size;
+    _Alignas(16) unsigned char data[];
+};
+
+// Bump allocator, every allocation of the arena is released at once when the arena is reset or freed
+struct Arena_s{
+    struct ArenaBlock_s* first_block;
+    struct ArenaBlock_s* block;     // Block being filled
+    size_t used;                    // Bytes used in the block being filled
+    size_t allocated;               // Bytes allocated since the counter was cleared, the resets keep it
+};
+
+// Priority queue node for A* path finding. The node stores the sets of its table that changed from the
+// table of its base node, or every set when it has no base, so a successor only copies the sets of its move
+struct PriorityQueue_s{
+    const struct PriorityQueue_s* base;
+    int chain_length;       // Number of bases before a node storing every set
+    int nb_sets;
+    uint64_t hash;
+    uint64_t illegal_sets;
+    uint64_t partial_sets;
+    uint64_t empty_sets;
+    uint64_t stored_sets;   // Indexes of the sets stored by the node
+    int g;
+    float h;
+    int heap_index;         // Position in the heap, -1 when the node is not queued
+    unsigned long order;    // Insertion number, breaks ties between nodes of same f = g + h
+    struct PriorityQueue_s* previous_set;
+    struct TileBitboard_s sets[];   // Stored sets by increasing index
+};
+
+// Array backed binary min heap of priority queue nodes ordered by f = g + h then insertion order
+struct PriorityQueueHeap_s{
+    struct PriorityQueue_s** nodes;
+    int size;
+    int capacity;
+    unsigned long next_order;
+};
+
+// Move of a tile of or to the illegal set of a table
+struct TableMove_s{
+    uint8_t kind;       // enum MoveKind_e
+    uint8_t bit;        // Bit of the moved tile
+    uint8_t set_index;  // Set receiving the tile of the illegal set or giving its tile to the illegal set
+};
+
+// Sets of a table overwritten by a move, enough to take the move back
+struct TableUndo_s{
+    int nb_sets;
+    int set_indexes[2];
+    struct TileBitboard_s sets[2];
+};
+
+#ifdef RUMMIKUB_STATS
+#define STATS_ADD(stats, counter, value) ((stats)->counter += (value))
+#define STATS_MAX(stats, counter, value) ((stats)->counter = (value) > (stats)->counter ? (value) : (stats)->counter)
+#define STATS_TIMER_START(timer) uint64_t timer##_start = ReadCycleCounter()
+#define STATS_TIMER_RESUME(timer) (timer##_start = ReadCycleCounter())
+#define STATS_TIMER_STOP(stats, timer) ((stats)->cycles[timer] += ReadCycleCounter() - timer##_start)
+#else
+#define STATS_ADD(stats, counter, value) ((void)(stats))
+#define STATS_MAX(stats, counter, value) ((void)(stats))
+#define STATS_TIMER_START(timer) ((void)0)
+#define STATS_TIMER_RESUME(timer) ((void)0)
+#define STATS_TIMER_STOP(stats, timer) ((void)(stats))
+#endif
+
+// Queue, memory and counters of an A* search, reused by the successive searches of a worker
+struct AStarSearch_s{
+    struct PriorityQueueHeap_s queue;
+    struct TranspositionTable_s transpositions;
+    struct Arena_s arena;
+    struct SearchStats_s stats;
+    Heuristic_f heuristic;
+    int max_depth;              // Tables reached with more moves are not expanded
+    bool iterative_deepening;   // Search with IDA* on one table instead of A*, without queue nor transposition table
+    // Color permutations other than the identity leaving the tiles of the searched table unchanged, the tables
+    // they map to each other are resolved by the same moves and share one transposition entry
+    uint8_t symmetries[NB_COLOR_PERMUTATIONS];
+    int nb_symmetries;
+    uint64_t deadline_ns;       // Monotonic clock time when the search stops, 0 without deadline
+    bool expired;               // The deadline passed, the searches return without result
+    bool out_of_memory;         // An allocation failed, the search stops as if expired and the solve fails
+};
+
+// Header of a solve cache file
+struct SolveCacheHeader_s{
+    char magic[8];
+    uint32_t version;
+    uint32_t entry_size;    // Size of an entry, a file written with another layout is not used
+    uint64_t nb_buckets;    // Power of 2
+    uint32_t clock;         // Incremented by each lookup hit and store
+};
+
+// Result of a solve stored in the cache. The game state is stored with the colors permuted to its canonical form,
+// the key is written last so that a process reading the file never uses a partly written entry
+struct SolveCacheEntry_s{
+    uint64_t key;                       // Canonical hash of the game state and solver, 0 for an empty entry
+    struct TileBitboard_s rack_tiles;   // Canonical rack and table tiles checked on lookup
+    struct TileBitboard_s table_tiles;
+    uint32_t solver;                    // Engine and search settings that found the result
+    uint32_t last_used;                 // Clock of the last hit or store, the least recently used entry of a bucket is replaced
+    uint32_t nb_melds;
+    uint64_t melds[MAX_TABLE_SETS];     // Melds of the table after the placement, a meld has one copy of each tile
+};
+
+// Memory mapped solve cache file, the read only mode maps it shared and never writes
+struct SolveCache_s{
+    struct SolveCacheHeader_s* header;
+    struct SolveCacheEntry_s* entries;
+    size_t map_size;
+    bool read_only;
+};
+
+// Header of a run table file, followed by the best run score of each color configuration
+struct RunTableHeader_s{
+    char magic[8];
+    uint32_t version;
+    uint32_t nb_configs;
+};
+
+// Memory mapped run table. The configuration of a color is the sum of count(n) * 3^(n - 1) over its numbers,
+// it is found from the two bitboard words of the color lane
+struct RunTable_s{
+    const uint8_t* scores;      // Highest score of the tiles of a configuration that runs can hold
+    void* map;
+    size_t map_size;
+    uint32_t lane_configs[1 << NB_NUMBERS];     // Configuration of the numbers of one copy
+};
+
+// Sub-search of an A* layer : a rack tile put in a table set (nb_sets for a new set) before resolving the table
+struct AStarCandidate_s{
+    int set_index;
+    int bit;
+};
+
+// Result of a sub-search, allocated in the moves arena of the worker that ran it
+struct AStarResult_s{
+    struct PriorityQueue_s* state;  // Resolved table without its steps, NULL when the search failed
+};
+
+// Thread running sub-searches with its own memory, kept for the whole solve
+struct AStarWorker_s{
+    struct AStarPool_s* pool;
+    int index;
+    pthread_t thread;
+    struct Arena_s moves_arena;
+    struct AStarSearch_s search;
+    // The worker takes its candidates from next, the other workers steal them from end
+    pthread_mutex_t lock;
+    int next;
+    int end;
+};
+
+// Work stealing pool running the sub-searches of a layer, the worker 0 is the thread of the solve
+struct AStarPool_s{
+    struct AStarWorker_s workers[MAX_SOLVER_THREADS];
+    int nb_workers;
+    pthread_mutex_t lock;
+    pthread_cond_t layer_started;
+    pthread_cond_t layer_done;
+    unsigned long layer;    // Incremented to start a layer
+    int nb_running;         // Threads still running the layer
+    bool stop;
+    // Layer being run
+    const struct TableState_s* table_state;
+    const struct AStarCandidate_s* candidates;
+    struct AStarResult_s* results;
+    int nb_candidates;
+};
+
+void* ArenaAlloc(struct Arena_s* arena, size_t size);
+void InitArena(struct Arena_s* arena);
+void ResetArena(struct Arena_s* arena);
+void FreeArena(struct Arena_s* arena);
+bool AddSetToTableState(struct TableState_s* table_state, struct TileBitboard_s set);
+int GetRunTableBound(const struct RunTable_s* run_table, struct TileBitboard_s tiles);
+
+static const char tile_colors[NB_COLORS] = {'R', 'B', 'G', 'Y'};
+
+// Return the index of a color (R,B,G,Y) or -1 if the color is unknown
+int GetColorIndex(char color)
+{
+    switch(color)
+    {
+        case 'R':
+            return 0;
+        case 'B':
+            return 1;
+        case 'G':
+            return 2;
+        case 'Y':
+            return 3;
+    }
+    return -1;
+}
+
+// Return the bitboard bit of a tile or -1 if the tile is not a game tile
+int GetTileBit(int number, char color)
+{
+    int color_index = GetColorIndex(color);
+    if(color_index < 0 || number < 1 || number > NB_NUMBERS)
+        return -1;
+    return color_index * COLOR_LANE_BITS + number - 1;
+}
+
+int GetBitNumber(int bit)
+{
+    return bit % COLOR_LANE_BITS + 1;
+}
+
+char GetBitColor(int bit)
+{
+    return tile_colors[bit / COLOR_LANE_BITS];
+}
+
+// Add one copy of the tile at the given bit, return false if both copies are already in the bitboard
+bool AddBitToBitboard(struct TileBitboard_s* bitboard, int bit)
+{
+    uint64_t mask = 1ULL << bit;
+    if(bitboard->two & mask)
+        return false;
+    if(bitboard->one & mask)
+        bitboard->two |= mask;
+    else
+        bitboard->one |= mask;
+    return true;
+}
+
+// Remove one copy of the tile at the given bit, return false if the tile is not in the bitboard
+bool RemoveBitFromBitboard(struct TileBitboard_s* bitboard, int bit)
+{
+    uint64_t mask = 1ULL << bit;
+    if(!(bitboard->one & mask))
+        return false;
+    if(bitboard->two & mask)
+        bitboard->two &= ~mask;
+    else
+        bitboard->one &= ~mask;
+    return true;
+}
+
+bool AddTileToBitboard(struct TileBitboard_s* bitboard, int number, char color)
+{
+    int bit = GetTileBit(number, color);
+    if(bit < 0)
+        return false;
+    return AddBitToBitboard(bitboard, bit);
+}
+
+int GetBitboardTileCount(struct TileBitboard_s bitboard, int bit)
+{
+    return (int)((bitboard.one >> bit) & 1) + (int)((bitboard.two >> bit) & 1);
+}
+
+uint8_t GetTileId(int bit, int copy)
+{
+    return bit | (copy ? TILE_ID_COPY : 0);
+}
+
+int GetTileIdBit(uint8_t id)
+{
+    return id & TILE_ID_BIT_MASK;
+}
+
+// An id is a game tile when it only has a copy and a bit of a tile number of a color lane
+bool IsTileId(uint8_t id)
+{
+    return !(id & ~(TILE_ID_COPY | TILE_ID_BIT_MASK)) && (ALL_TILES_MASK >> GetTileIdBit(id) & 1);
+}
+
+bool AddTileIdToBitboard(struct TileBitboard_s* bitboard, uint8_t id)
+{
+    return AddBitToBitboard(bitboard, GetTileIdBit(id));
+}
+
+int GetTileIdsFromBitboard(struct TileBitboard_s bitboard, uint8_t* ids)
+{
+    int nb_ids = 0;
+    for(int copy = 0; copy < 2; copy++)
+    {
+        uint64_t word = copy ? bitboard.two : bitboard.one;
+        while(word)
+        {
+            ids[nb_ids++] = GetTileId(__builtin_ctzll(word), copy);
+            word &= word - 1;
+        }
+    }
+    return nb_ids;
+}
+
+struct TileBitboard_s GetBitboardFromTileIds(const uint8_t* ids, int nb_ids)
+{
+    struct TileBitboard_s bitboard = {0, 0};
+    for(int i = 0; i < nb_ids; i++)
+        AddTileIdToBitboard(&bitboard, ids[i]);
+    return bitboard;
+}
+
+// Number of tiles in the bitboard, copies included
+int GetBitboardTilesNumber(struct TileBitboard_s bitboard)
+{
+    return __builtin_popcountll(bitboard.one) + __builtin_popcountll(bitboard.two);
+}
+
+bool IsBitboardEmpty(struct TileBitboard_s bitboard)
+{
+    return bitboard.one == 0;
+}
+
+bool AreBitboardsEqual(struct TileBitboard_s a, struct TileBitboard_s b)
+{
+    return a.one == b.one && a.two == b.two;
+}
+
+// Check if every tile of a (with its copies) is in b
+bool IsBitboardSubsetOf(struct TileBitboard_s a, struct TileBitboard_s b)
+{
+    return !(a.one & ~b.one) && !(a.two & ~b.two);
+}
+
+// Multiset union of two bitboards, tiles copies are added and saturate at two copies
+struct TileBitboard_s BitboardUnion(struct TileBitboard_s a, struct TileBitboard_s b)
+{
+    return (struct TileBitboard_s){a.one | b.one, a.two | b.two | (a.one & b.one)};
+}
+
+// Multiset difference of two bitboards, tiles copies are subtracted and saturate at zero copy
+struct TileBitboard_s BitboardDifference(struct TileBitboard_s a, struct TileBitboard_s b)
+{
+    return (struct TileBitboard_s){(a.one & ~b.one) | (a.two & ~b.two), a.two & ~b.one};
+}
+
+// Sum of the numbers of the tiles in a bitboard word, the number of a bit is its lane position + 1
+static int GetBitboardWordScore(uint64_t word)
+{
+    return __builtin_popcountll(word)
+        + __builtin_popcountll(word & (0x0AAAULL * NUMBER_COLUMN))
+        + 2 * __builtin_popcountll(word & (0x0CCCULL * NUMBER_COLUMN))
+        + 4 * __builtin_popcountll(word & (0x10F0ULL * NUMBER_COLUMN))
+        + 8 * __builtin_popcountll(word & (0x1F00ULL * NUMBER_COLUMN));
+}
+
+int GetBitboardScore(struct TileBitboard_s bitboard)
+{
+    return GetBitboardWordScore(bitboard.one) + GetBitboardWordScore(bitboard.two);
+}
+
+// Fold the four color lanes, a bit is set for each number present in any color
+static uint64_t GetBitboardNumbers(uint64_t word)
+{
+    return (word | (word >> 16) | (word >> 32) | (word >> 48)) & COLOR_LANE_MASK;
+}
+
+// Bit of the tile with the lowest number (lowest color index on ties), the bitboard must not be empty
+int GetBitboardLowestBit(struct TileBitboard_s bitboard)
+{
+    int number_bit = __builtin_ctzll(GetBitboardNumbers(bitboard.one));
+    return __builtin_ctzll(bitboard.one & ((1ULL << number_bit) * NUMBER_COLUMN));
+}
+
+// Bit of the tile with the highest number (lowest color index on ties), the bitboard must not be empty
+int GetBitboardHighestBit(struct TileBitboard_s bitboard)
+{
+    int number_bit = 63 - __builtin_clzll(GetBitboardNumbers(bitboard.one));
+    return __builtin_ctzll(bitboard.one & ((1ULL << number_bit) * NUMBER_COLUMN));
+}
+
+// A run is 3 to 13 tiles of the same color with consecutive numbers
+bool IsBitboardRun(struct TileBitboard_s bitboard)
+{
+    if(!bitboard.one || bitboard.two)
+        return false;
+    int shift = __builtin_ctzll(bitboard.one);
+    uint64_t sequence = bitboard.one >> shift;
+    // Consecutive tiles, the lane padding bits prevent a sequence across two colors
+    if(sequence & (sequence + 1))
+        return false;
+    return __builtin_popcountll(bitboard.one) >= 3;
+}
+
+// A group is 3 or 4 tiles of the same number with different colors
+bool IsBitboardGroup(struct TileBitboard_s bitboard)
+{
+    if(!bitboard.one || bitboard.two)
+        return false;
+    int number_bit = __builtin_ctzll(bitboard.one) % COLOR_LANE_BITS;
+    if(bitboard.one & ~((1ULL << number_bit) * NUMBER_COLUMN))
+        return false;
+    return __builtin_popcountll(bitboard.one) >= 3;
+}
+
+// An empty set is valid, otherwise it must be a run or a group
+bool IsBitboardValidSet(struct TileBitboard_s bitboard)
+{
+    if(!bitboard.one)
+        return true;
+    return IsBitboardRun(bitboard) || IsBitboardGroup(bitboard);
+}
+
+// A partial set is one tile, or two tiles that are the start of a run or of a group
+bool IsBitboardPartialSet(struct TileBitboard_s bitboard)
+{
+    if(!bitboard.one || bitboard.two)
+        return false;
+    int nb_tiles = __builtin_popcountll(bitboard.one);
+    if(nb_tiles == 1)
+        return true;
+    if(nb_tiles > 2)
+        return false;
+    int shift = __builtin_ctzll(bitboard.one);
+    uint64_t other = bitboard.one >> shift;
+    // Same color and adjacent numbers, the lane padding bits prevent a run across two colors
+    if(other == 3)
+        return true;
+    // Same number and different colors
+    return (other & ~NUMBER_COLUMN) == 0;
+}
+
+// Is a set with one more tile a run, a group or a partial set ? The set must be made of single tiles other than
+// the new one, then the tiles must be consecutive numbers of one color or one number in different colors
+static inline bool CanSetTakeTile(struct TileBitboard_s set, uint64_t tile)
+{
+    if(!set.one || set.two || (set.one & tile))
+        return false;
+    uint64_t tiles = set.one | tile;
+    uint64_t lowest = tiles & -tiles;
+    // The lane padding bits prevent a sequence across two colors, the lowest tile has the lowest color of a group
+    return !((tiles + lowest) & tiles) || !(tiles & ~(lowest * NUMBER_COLUMN));
+}
+
+#if defined(__AVX2__)
+// CanSetTakeTile on the 4 sets starting at sets, bit i of the result is for the set i
+static inline int CanSetsTakeTile4(const struct TileBitboard_s* sets, __m256i tile)
+{
+    __m256i zero = _mm256_setzero_si256();
+    __m256i a = _mm256_loadu_si256((const __m256i*)sets);
+    __m256i b = _mm256_loadu_si256((const __m256i*)(sets + 2));
+    // Words in the order of the sets 0, 2, 1, 3
+    __m256i one = _mm256_unpacklo_epi64(a, b);
+    __m256i two = _mm256_unpackhi_epi64(a, b);
+    __m256i single = _mm256_andnot_si256(_mm256_cmpeq_epi64(one, zero),
+                     _mm256_and_si256(_mm256_cmpeq_epi64(two, zero), _mm256_cmpeq_epi64(_mm256_and_si256(one, tile), zero)));
+    __m256i tiles = _mm256_or_si256(one, tile);
+    __m256i lowest = _mm256_and_si256(tiles, _mm256_sub_epi64(zero, tiles));
+    __m256i run = _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_add_epi64(tiles, lowest), tiles), zero);
+    __m256i column = _mm256_or_si256(_mm256_or_si256(lowest, _mm256_slli_epi64(lowest, 16)),
+                                     _mm256_or_si256(_mm256_slli_epi64(lowest, 32), _mm256_slli_epi64(lowest, 48)));
+    __m256i group = _mm256_cmpeq_epi64(_mm256_andnot_si256(column, tiles), zero);
+    int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_and_si256(single, _mm256_or_si256(run, group))));
+    return (mask & 9) | ((mask & 2) << 1) | ((mask & 4) >> 1);
+}
+#elif defined(__SSE2__)
+// Lanes of 64 bits equal to zero, SSE2 only compares 32 bits lanes
+static inline __m128i IsZeroEpi64(__m128i words)
+{
+    __m128i zero = _mm_cmpeq_epi32(words, _mm_setzero_si128());
+    return _mm_and_si128(zero, _mm_shuffle_epi32(zero, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+// CanSetTakeTile on the 2 sets starting at sets, bit i of the result is for the set i
+static inline int CanSetsTakeTile2(const struct TileBitboard_s* sets, __m128i tile)
+{
+    __m128i a = _mm_loadu_si128((const __m128i*)sets);
+    __m128i b = _mm_loadu_si128((const __m128i*)(sets + 1));
+    __m128i one = _mm_unpacklo_epi64(a, b);
+    __m128i two = _mm_unpackhi_epi64(a, b);
+    __m128i single = _mm_andnot_si128(IsZeroEpi64(one), _mm_and_si128(IsZeroEpi64(two), IsZeroEpi64(_mm_and_si128(one, tile))));
+    __m128i tiles = _mm_or_si128(one, tile);
+    __m128i lowest = _mm_and_si128(tiles, _mm_sub_epi64(_mm_setzero_si128(), tiles));
+    __m128i run = IsZeroEpi64(_mm_and_si128(_mm_add_epi64(tiles, lowest), tiles));
+    __m128i column = _mm_or_si128(_mm_or_si128(lowest, _mm_slli_epi64(lowest, 16)),
+                                  _mm_or_si128(_mm_slli_epi64(lowest, 32), _mm_slli_epi64(lowest, 48)));
+    __m128i group = IsZeroEpi64(_mm_andnot_si128(column, tiles));
+    return _mm_movemask_pd(_mm_castsi128_pd(_mm_and_si128(single, _mm_or_si128(run, group))));
+}
+#endif
+
+// Mask of the sets of a table that can take the tile of the given bit (see CanSetTakeTile). The sets are checked
+// 4 at a time with AVX2 or 2 at a time with SSE2 when the solver is built for them, the others one by one
+uint64_t GetSetsTakingTile(const struct TableState_s* table_state, int bit)
+{
+    uint64_t tile = 1ULL << bit;
+    uint64_t sets = 0;
+    int i = 0;
+#if defined(__AVX2__)
+    __m256i tile_vector = _mm256_set1_epi64x(tile);
+    for(; i + 4 <= table_state->nb_sets; i += 4)
+        sets |= (uint64_t)CanSetsTakeTile4(&table_state->sets[i], tile_vector) << i;
+#elif defined(__SSE2__)
+    __m128i tile_vector = _mm_set1_epi64x(tile);
+    for(; i + 2 <= table_state->nb_sets; i += 2)
+        sets |= (uint64_t)CanSetsTakeTile2(&table_state->sets[i], tile_vector) << i;
+#endif
+    for(; i < table_state->nb_sets; i++)
+        sets |= (uint64_t)CanSetTakeTile(table_state->sets[i], tile) << i;
+    return sets;
+}
+
+static uint64_t SplitMix64(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// The generator state is 4 successive outputs of SplitMix64 from the seed, so close seeds give unrelated draws
+void SeedRandom(struct Random_s* random, uint64_t seed)
+{
+    for(int i = 0; i < 4; i++)
+        random->state[i] = SplitMix64(seed + i * 0x9E3779B97F4A7C15ULL);
+}
+
+static inline uint64_t RotateLeft(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+uint64_t GetRandom(struct Random_s* random)
+{
+    uint64_t* state = random->state;
+    uint64_t result = RotateLeft(state[1] * 5, 7) * 9;
+    uint64_t t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = RotateLeft(state[3], 45);
+    return result;
+}
+
+// Multiply the 32 high bits of a draw by the bound and keep the high word, the draws falling in the low words
+// that would favor some results are drawn again
+uint32_t GetRandomBelow(struct Random_s* random, uint32_t bound)
+{
+    uint64_t product = (GetRandom(random) >> 32) * bound;
+    if((uint32_t)product < bound)
+    {
+        uint32_t threshold = -bound % bound;
+        while((uint32_t)product < threshold)
+            product = (GetRandom(random) >> 32) * bound;
+    }
+    return product >> 32;
+}
+
+// Fisher-Yates shuffle of the tiles, the draws then pop the end of the pile
+void InitTilePool(struct TilePool_s* pool, struct Random_s* random)
+{
+    for(int i = 0; i < NB_TILES; i++)
+        pool->tiles[i] = GetTileId((i >> 1) / NB_NUMBERS * COLOR_LANE_BITS + (i >> 1) % NB_NUMBERS, i & 1);
+    for(int i = NB_TILES - 1; i > 0; i--)
+    {
+        int j = GetRandomBelow(random, i + 1);
+        uint8_t tile = pool->tiles[i];
+        pool->tiles[i] = pool->tiles[j];
+        pool->tiles[j] = tile;
+    }
+    pool->nb_tiles = NB_TILES;
+}
+
+int DrawTileFromPool(struct TilePool_s* pool)
+{
+    return pool->nb_tiles ? pool->tiles[--pool->nb_tiles] : -1;
+}
+
+struct TileBitboard_s DrawTilesFromPool(struct TilePool_s* pool, int nb_tiles)
+{
+    struct TileBitboard_s tiles = {0, 0};
+    for(int i = 0; i < nb_tiles && pool->nb_tiles; i++)
+        AddTileIdToBitboard(&tiles, pool->tiles[--pool->nb_tiles]);
+    return tiles;
+}
+
+// Zobrist key of a copy (0 or 1) of the tile at the given bit
+static uint64_t GetZobristKey(int bit, int copy)
+{
+    return SplitMix64(ZOBRIST_SEED ^ (uint64_t)(bit * 2 + copy));
+}
+
+// Zobrist hash of a set, xor of the keys of its tiles
+uint64_t GetSetZobristHash(struct TileBitboard_s set)
+{
+    uint64_t hash = 0;
+    uint64_t tiles = set.one;
+    while(tiles)
+    {
+        int bit = __builtin_ctzll(tiles);
+        tiles &= tiles - 1;
+        hash ^= GetZobristKey(bit, 0);
+        if(set.two & (1ULL << bit))
+            hash ^= GetZobristKey(bit, 1);
+    }
+    return hash;
+}
+
+// Contribution of a set to the table hash, the table hash is the sum of its sets contributions so the sets order
+// does not matter, the set hash is mixed so that splitting or merging sets changes the table hash
+static uint64_t GetSetHashContribution(struct TileBitboard_s set)
+{
+    if(!set.one)
+        return 0;
+    return SplitMix64(GetSetZobristHash(set));
+}
+
+// Every order of the colors, a tile of color c gets the color color_permutations[p][c], the identity comes first
+static const uint8_t color_permutations[NB_COLOR_PERMUTATIONS][NB_COLORS] = {
+    {0, 1, 2, 3},
+    {0, 1, 3, 2},
+    {0, 2, 1, 3},
+    {0, 2, 3, 1},
+    {0, 3, 1, 2},
+    {0, 3, 2, 1},
+    {1, 0, 2, 3},
+    {1, 0, 3, 2},
+    {1, 2, 0, 3},
+    {1, 2, 3, 0},
+    {1, 3, 0, 2},
+    {1, 3, 2, 0},
+    {2, 0, 1, 3},
+    {2, 0, 3, 1},
+    {2, 1, 0, 3},
+    {2, 1, 3, 0},
+    {2, 3, 0, 1},
+    {2, 3, 1, 0},
+    {3, 0, 1, 2},
+    {3, 0, 2, 1},
+    {3, 1, 0, 2},
+    {3, 1, 2, 0},
+    {3, 2, 0, 1},
+    {3, 2, 1, 0}
+};
+
+// Bitboard word with the colors of its tiles permuted
+static uint64_t PermuteColorLanes(uint64_t tiles, int permutation)
+{
+    uint64_t permuted = 0;
+    for(int color = 0; color < NB_COLORS; color++)
+        permuted |= ((tiles >> (color * COLOR_LANE_BITS)) & COLOR_LANE_MASK) << (color_permutations[permutation][color] * COLOR_LANE_BITS);
+    return permuted;
+}
+
+// Bitboard with the colors of its tiles permuted
+struct TileBitboard_s PermuteBitboardColors(struct TileBitboard_s bitboard, int permutation)
+{
+    return (struct TileBitboard_s){PermuteColorLanes(bitboard.one, permutation), PermuteColorLanes(bitboard.two, permutation)};
+}
+
+// Store the color permutations other than the identity that leave the tiles unchanged, return their number
+int GetColorSymmetries(struct TileBitboard_s tiles, uint8_t* symmetries)
+{
+    int nb_symmetries = 0;
+    for(int permutation = 1; permutation < NB_COLOR_PERMUTATIONS; permutation++)
+    {
+        struct TileBitboard_s permuted = PermuteBitboardColors(tiles, permutation);
+        if(permuted.one == tiles.one && permuted.two == tiles.two)
+            symmetries[nb_symmetries++] = permutation;
+    }
+    return nb_symmetries;
+}
+
+// Smallest hash of a table and of the tables the symmetries map it to, the same for all of them
+uint64_t GetSymmetricTableHash(const struct TableState_s* table_state, const uint8_t* symmetries, int nb_symmetries)
+{
+    uint64_t min_hash = table_state->hash;
+    for(int i = 0; i < nb_symmetries; i++)
+    {
+        uint64_t hash = 0;
+        for(int set_index = 0; set_index < table_state->nb_sets; set_index++)
+            hash += GetSetHashContribution(PermuteBitboardColors(table_state->sets[set_index], symmetries[i]));
+        if(hash < min_hash)
+            min_hash = hash;
+    }
+    return min_hash;
+}
+
+void InitTableState(struct TableState_s* table_state)
+{
+    table_state->nb_sets = 0;
+    table_state->hash = 0;
+    table_state->illegal_sets = 0;
+    table_state->partial_sets = 0;
+    table_state->empty_sets = 0;
+    table_state->changed_sets = 0;
+    memset(table_state->tile_sets, 0, sizeof(table_state->tile_sets));
+}
+
+// Move the set index between the tile masks of the tiles that left or entered the set
+static void UpdateTableTileSets(struct TableState_s* table_state, int set_index, struct TileBitboard_s old_set, struct TileBitboard_s set)
+{
+    uint64_t mask = 1ULL << set_index;
+    uint64_t removed = old_set.one & ~set.one;
+    uint64_t added = set.one & ~old_set.one;
+    while(removed)
+    {
+        table_state->tile_sets[__builtin_ctzll(removed)] &= ~mask;
+        removed &= removed - 1;
+    }
+    while(added)
+    {
+        table_state->tile_sets[__builtin_ctzll(added)] |= mask;
+        added &= added - 1;
+    }
+}
+
+// Rebuild the tile masks of a table state from its sets
+void IndexTableStateTiles(struct TableState_s* table_state)
+{
+    memset(table_state->tile_sets, 0, sizeof(table_state->tile_sets));
+    for(int i = 0; i < table_state->nb_sets; i++)
+        UpdateTableTileSets(table_state, i, (struct TileBitboard_s){0, 0}, table_state->sets[i]);
+}
+
+// Put the set index in the mask of its kind
+static void UpdateTableSetKind(struct TableState_s* table_state, int set_index, struct TileBitboard_s set)
+{
+    uint64_t mask = 1ULL << set_index;
+    table_state->illegal_sets &= ~mask;
+    table_state->partial_sets &= ~mask;
+    table_state->empty_sets &= ~mask;
+    table_state->changed_sets |= mask;
+    if(!set.one)
+        table_state->empty_sets |= mask;
+    else if(!IsBitboardValidSet(set))
+    {
+        table_state->illegal_sets |= mask;
+        if(IsBitboardPartialSet(set))
+            table_state->partial_sets |= mask;
+    }
+}
+
+// Replace a set of the table and update the table hash and set masks
+void SetTableStateSet(struct TableState_s* table_state, int set_index, struct TileBitboard_s set)
+{
+    table_state->hash -= GetSetHashContribution(table_state->sets[set_index]);
+    table_state->hash += GetSetHashContribution(set);
+    UpdateTableTileSets(table_state, set_index, table_state->sets[set_index], set);
+    table_state->sets[set_index] = set;
+    UpdateTableSetKind(table_state, set_index, set);
+}
+
+// Add one copy of a tile to a table set, return false if both copies are already in the set
+bool AddBitToTableSet(struct TableState_s* table_state, int set_index, int bit)
+{
+    struct TileBitboard_s set = table_state->sets[set_index];
+    if(!AddBitToBitboard(&set, bit))
+        return false;
+    SetTableStateSet(table_state, set_index, set);
+    return true;
+}
+
+// Remove one copy of a tile from a table set, return false if the tile is not in the set
+bool RemoveBitFromTableSet(struct TableState_s* table_state, int set_index, int bit)
+{
+    struct TileBitboard_s set = table_state->sets[set_index];
+    if(!RemoveBitFromBitboard(&set, bit))
+        return false;
+    SetTableStateSet(table_state, set_index, set);
+    return true;
+}
+
+// Union of all the tiles of a table state
+struct TileBitboard_s GetTableStateTiles(const struct TableState_s* table_state)
+{
+    struct TileBitboard_s tiles = {0, 0};
+    for(int i = 0; i < table_state->nb_sets; i++)
+        tiles = BitboardUnion(tiles, table_state->sets[i]);
+    return tiles;
+}
+
+// Append a set to a table state, return false if the table is full
+bool AddSetToTableState(struct TableState_s* table_state, struct TileBitboard_s set)
+{
+    if(table_state->nb_sets == MAX_TABLE_SETS)
+        return false;
+    table_state->sets[table_state->nb_sets] = set;
+    table_state->hash += GetSetHashContribution(set);
+    UpdateTableTileSets(table_state, table_state->nb_sets, (struct TileBitboard_s){0, 0}, set);
+    UpdateTableSetKind(table_state, table_state->nb_sets++, set);
+    return true;
+}
+
+// Remove the last set of a table state
+void RemoveLastSetFromTableState(struct TableState_s* table_state)
+{
+    int set_index = --table_state->nb_sets;
+    table_state->hash -= GetSetHashContribution(table_state->sets[set_index]);
+    UpdateTableTileSets(table_state, set_index, table_state->sets[set_index], (struct TileBitboard_s){0, 0});
+    UpdateTableSetKind(table_state, set_index, (struct TileBitboard_s){0, 0});
+    table_state->empty_sets &= ~(1ULL << set_index);
+    table_state->changed_sets &= ~(1ULL << set_index);
+}
+
+// Remove the empty sets of a table state keeping the order of the other sets
+void RemoveEmptySetsFromTableState(struct TableState_s* table_state)
+{
+    if(!table_state->empty_sets)
+        return;
+    int idx = 0;
+    uint64_t illegal_sets = 0;
+    uint64_t partial_sets = 0;
+    uint64_t changed_sets = 0;
+    for(int i = 0; i < table_state->nb_sets; i++)
+    {
+        if(!table_state->sets[i].one)
+            continue;
+        illegal_sets |= ((table_state->illegal_sets >> i) & 1) << idx;
+        partial_sets |= ((table_state->partial_sets >> i) & 1) << idx;
+        changed_sets |= (uint64_t)(((table_state->changed_sets >> i) & 1) || i != idx) << idx;
+        table_state->sets[idx++] = table_state->sets[i];
+    }
+    table_state->nb_sets = idx;
+    table_state->illegal_sets = illegal_sets;
+    table_state->partial_sets = partial_sets;
+    table_state->changed_sets = changed_sets;
+    table_state->empty_sets = 0;
+    IndexTableStateTiles(table_state);
+}
+
+// Take a tile out of a table set, a run is split in two sets if the tile was in the middle of it
+bool TakeTileFromTableSet(struct TableState_s* table_state, int set_index, int bit)
+{
+    struct TileBitboard_s set = table_state->sets[set_index];
+    bool is_run = IsBitboardRun(set);
+    if(!RemoveBitFromBitboard(&set, bit))
+        return false;
+    uint64_t lower = set.one & ((1ULL << bit) - 1);
+    uint64_t upper = set.one & ~((1ULL << bit) - 1);
+    if(is_run && lower && upper)
+    {
+        if(!AddSetToTableState(table_state, (struct TileBitboard_s){upper, 0}))
+            return false;
+        set.one = lower;
+    }
+    SetTableStateSet(table_state, set_index, set);
+    return true;
+}
+
+bool AreValidTableSets(const struct TableState_s* table_state)
+{
+    return !table_state->illegal_sets;
+}
+
+int EncodeGameState(struct TileBitboard_s rack_tiles, const struct TableState_s* table_state, uint8_t* buffer)
+{
+    uint8_t* ids = buffer + GAME_STATE_HEADER_BYTES;
+    int nb_rack_tiles = GetTileIdsFromBitboard(rack_tiles, ids);
+    int nb_tiles = nb_rack_tiles;
+    // The copy of a table tile is the number of copies already written
+    struct TileBitboard_s written_tiles = rack_tiles;
+    for(int i = 0; i < table_state->nb_sets; i++)
+    {
+        uint8_t set_ids[2 * NB_COLORS * COLOR_LANE_BITS];
+        int nb_set_tiles = GetTileIdsFromBitboard(table_state->sets[i], set_ids);
+        for(int j = 0; j < nb_set_tiles; j++)
+        {
+            int bit = GetTileIdBit(set_ids[j]);
+            int copy = GetBitboardTileCount(written_tiles, bit);
+            if(!AddBitToBitboard(&written_tiles, bit))
+                return -1;
+            ids[nb_tiles++] = GetTileId(bit, copy) | (j ? 0 : GAME_STATE_SET_START);
+        }
+    }
+    buffer[0] = nb_rack_tiles;
+    buffer[1] = nb_tiles - nb_rack_tiles;
+    return GAME_STATE_HEADER_BYTES + nb_tiles;
+}
+
+const char* DecodeGameState(const uint8_t* buffer, size_t size, struct TileBitboard_s* rack_tiles, struct TableState_s* table_state)
+{
+    if(size < GAME_STATE_HEADER_BYTES || buffer[0] + buffer[1] > NB_TILES || size != (size_t)GAME_STATE_HEADER_BYTES + buffer[0] + buffer[1])
+        return "invalid game state size";
+    const uint8_t* ids = buffer + GAME_STATE_HEADER_BYTES;
+    int nb_rack_tiles = buffer[0];
+    int nb_tiles = nb_rack_tiles + buffer[1];
+    // Each id is a different tile of the game
+    uint64_t read_ids[2] = {0, 0};
+    *rack_tiles = (struct TileBitboard_s){0, 0};
+    InitTableState(table_state);
+    struct TileBitboard_s set = {0, 0};
+    for(int i = 0; i < nb_tiles; i++)
+    {
+        uint8_t id = ids[i] & ~GAME_STATE_SET_START;
+        bool set_start = ids[i] & GAME_STATE_SET_START;
+        if(!IsTileId(id) || read_ids[id >> 6] & (1ULL << (id & 63)))
+            return "invalid tile id";
+        read_ids[id >> 6] |= 1ULL << (id & 63);
+        if(i < nb_rack_tiles)
+        {
+            if(set_start)
+                return "invalid rack";
+            AddTileIdToBitboard(rack_tiles, id);
+            continue;
+        }
+        if(set_start)
+        {
+            if(set.one && !AddSetToTableState(table_state, set))
+                return "too many table sets";
+            set = (struct TileBitboard_s){0, 0};
+        }
+        else if(i == nb_rack_tiles)
+            return "invalid table";
+        AddTileIdToBitboard(&set, id);
+    }
+    if(set.one && !AddSetToTableState(table_state, set))
+        return "too many table sets";
+    return AreValidTableSets(table_state) ? NULL : "invalid table sets";
+}
+
+// Legal run or group of the game, tiles is the bitboard word of the meld
+struct Meld_s{
+    uint64_t tiles;
+    uint16_t numbers;   // One bit per number of the meld
+    uint8_t colors;     // One bit per color of the meld
+    uint8_t nb_tiles;
+    uint8_t score;
+    bool is_run;
+};
+
+// Every legal meld, runs first, generated by InitMeldTable
+struct MeldTable_s{
+    struct Meld_s melds[NB_MELDS];
+    int nb_melds;
+    // Index of the melds containing each tile bit, in the melds table order
+    uint16_t tile_melds[NB_COLORS * COLOR_LANE_BITS][MAX_TILE_MELDS];
+    uint8_t nb_tile_melds[NB_COLORS * COLOR_LANE_BITS];
+};
+
+static void AddMeldToTable(struct MeldTable_s* meld_table, uint64_t tiles, bool is_run)
+{
+    struct Meld_s* meld = &meld_table->melds[meld_table->nb_melds];
+    *meld = (struct Meld_s){tiles, (uint16_t)GetBitboardNumbers(tiles), 0, (uint8_t)__builtin_popcountll(tiles),
+                            (uint8_t)GetBitboardScore((struct TileBitboard_s){tiles, 0}), is_run};
+    for(int color = 0; color < NB_COLORS; color++)
+    {
+        if(tiles & (COLOR_LANE_MASK << (color * COLOR_LANE_BITS)))
+            meld->colors |= 1 << color;
+    }
+    while(tiles)
+    {
+        int bit = __builtin_ctzll(tiles);
+        tiles &= tiles - 1;
+        meld_table->tile_melds[bit][meld_table->nb_tile_melds[bit]++] = meld_table->nb_melds;
+    }
+    meld_table->nb_melds++;
+}
+
+// Generate the runs of 3 to 13 tiles of each color and the groups of 3 or 4 colors of each number
+void InitMeldTable(struct MeldTable_s* meld_table)
+{
+    meld_table->nb_melds = 0;
+    memset(meld_table->nb_tile_melds, 0, sizeof(meld_table->nb_tile_melds));
+    for(int color = 0; color < NB_COLORS; color++)
+    {
+        for(int length = 3; length <= NB_NUMBERS; length++)
+        {
+            for(int start = 0; start + length <= NB_NUMBERS; start++)
+                AddMeldToTable(meld_table, ((1ULL << length) - 1) << (color * COLOR_LANE_BITS + start), true);
+        }
+    }
+    for(int number = 0; number < NB_NUMBERS; number++)
+    {
+        uint64_t group = (1ULL << number) * NUMBER_COLUMN;
+        AddMeldToTable(meld_table, group, false);
+        for(int color = 0; color < NB_COLORS; color++)
+            AddMeldToTable(meld_table, group & ~(1ULL << (color * COLOR_LANE_BITS + number)), false);
+    }
+}
+
+// Store the indexes of the melds that can be made with the given tiles, return their number
+int GetMeldsFromTiles(const struct MeldTable_s* meld_table, struct TileBitboard_s tiles, uint16_t* meld_indexes)
+{
+    int nb_meld_indexes = 0;
+    for(int i = 0; i < meld_table->nb_melds; i++)
+    {
+        if(!(meld_table->melds[i].tiles & ~tiles.one))
+            meld_indexes[nb_meld_indexes++] = i;
+    }
+    return nb_meld_indexes;
+}
+
+// Best melds found by the combinations search
+struct CombinationsSearch_s{
+    struct TableState_s sets;       // Melds of the combination being built
+    struct TableState_s best_sets;
+    int best_score;
+    unsigned long nb_nodes;
+    const struct MeldTable_s* meld_table;
+    const struct RunTable_s* run_table;     // Tightens the bound of the remaining tiles when not NULL
+};
+
+// Decide the lowest tile not kept in the rack : put it in each meld it can make with the remaining tiles, or keep it
+static void SearchCombinations(struct CombinationsSearch_s* search, struct TileBitboard_s remaining_tiles, uint64_t kept_tiles, int score)
+{
+    search->nb_nodes++;
+    if(score > search->best_score)
+    {
+        search->best_score = score;
+        search->best_sets = search->sets;
+    }
+    uint64_t candidates = remaining_tiles.one & ~kept_tiles;
+    if(!candidates)
+        return;
+    // Even if every remaining tile was placed the score would not be better
+    struct TileBitboard_s candidate_tiles = BitboardDifference(remaining_tiles, (struct TileBitboard_s){kept_tiles, kept_tiles});
+    int bound = search->run_table ? GetRunTableBound(search->run_table, candidate_tiles) : GetBitboardScore(candidate_tiles);
+    if(score + bound <= search->best_score)
+        return;
+
+    int bit = __builtin_ctzll(candidates);
+    const struct MeldTable_s* meld_table = search->meld_table;
+    for(int i = 0; i < meld_table->nb_tile_melds[bit]; i++)
+    {
+        const struct Meld_s* meld = &meld_table->melds[meld_table->tile_melds[bit][i]];
+        if((meld->tiles & ~remaining_tiles.one) || (meld->tiles & kept_tiles))
+            continue;
+        struct TileBitboard_s meld_tiles = {meld->tiles, 0};
+        if(!AddSetToTableState(&search->sets, meld_tiles))
+            continue;
+        SearchCombinations(search, BitboardDifference(remaining_tiles, meld_tiles), kept_tiles, score + meld->score);
+        RemoveLastSetFromTableState(&search->sets);
+    }
+    SearchCombinations(search, remaining_tiles, kept_tiles | (1ULL << bit), score);
+}
+
+// Store in best_sets the melds made with the tiles that place the highest score and return the score,
+// the number of search nodes is stored in nb_nodes when it is not NULL
+int SolveCombinations(const struct MeldTable_s* meld_table, struct TileBitboard_s tiles, struct TableState_s* best_sets, unsigned long* nb_nodes, const struct RunTable_s* run_table)
+{
+    struct CombinationsSearch_s search;
+    search.meld_table = meld_table;
+    search.run_table = run_table;
+    InitTableState(&search.sets);
+    InitTableState(&search.best_sets);
+    search.best_score = 0;
+    search.nb_nodes = 0;
+    SearchCombinations(&search, tiles, 0, 0);
+    *best_sets = search.best_sets;
+    if(nb_nodes)
+        *nb_nodes = search.nb_nodes;
+    return search.best_score;
+}
+
+float heuristic(const struct TableState_s* table_state)
+{
+    int nb_partials_sets = __builtin_popcountll(table_state->partial_sets);
+    return (float)nb_partials_sets/2;
+}
+
+// A move changes the tiles of two sets, so it resolves at most two illegal sets
+float IllegalSetsHeuristic(const struct TableState_s* table_state)
+{
+    int nb_illegal_sets = __builtin_popcountll(table_state->illegal_sets);
+    return (float)((nb_illegal_sets + 1) / 2);
+}
+
+// Return the tiles that make a set of 3 tiles with a partial set of 2 tiles
+static uint64_t GetPairCompletions(uint64_t pair)
+{
+    int shift = __builtin_ctzll(pair);
+    // Same number, the other colors complete the group
+    if(((pair >> shift) & ~NUMBER_COLUMN) == 0)
+        return (NUMBER_COLUMN << (shift % COLOR_LANE_BITS)) & ~pair;
+    // Adjacent tiles of a run, the lane padding bits remove the numbers out of 1 to 13
+    return ((pair << 1) | (pair >> 1)) & ~pair & ALL_TILES_MASK;
+}
+
+// Return true if removing one tile of an illegal set of 3 tiles or more makes it valid
+static bool IsSetValidWithoutOneTile(struct TileBitboard_s set)
+{
+    uint64_t tiles = set.one;
+    while(tiles)
+    {
+        int bit = __builtin_ctzll(tiles);
+        tiles &= tiles - 1;
+        struct TileBitboard_s smaller_set = set;
+        RemoveBitFromBitboard(&smaller_set, bit);
+        if(IsBitboardValidSet(smaller_set))
+            return true;
+    }
+    return false;
+}
+
+// Return the tile filling the only hole of a run missing one number, 0 if the set is not such a run
+static uint64_t GetRunHole(struct TileBitboard_s set)
+{
+    if(set.two)
+        return 0;
+    int low = __builtin_ctzll(set.one);
+    int high = 63 - __builtin_clzll(set.one);
+    if(low / COLOR_LANE_BITS != high / COLOR_LANE_BITS || high - low != __builtin_popcountll(set.one))
+        return 0;
+    uint64_t span = ((1ULL << (high - low + 1)) - 1) << low;
+    return span & ~set.one;
+}
+
+// Lower bound of the moves changing an illegal set before it is valid or empty : a move adds or removes
+// one of its tiles. A single tile, a pair completed by a tile of the table, or a larger set fixed by
+// removing or adding one tile need one move, the other sets need two
+static int GetIllegalSetDeficit(struct TileBitboard_s set, bool is_partial, uint64_t table_tiles)
+{
+    int nb_tiles = GetBitboardTilesNumber(set);
+    if(nb_tiles == 1)
+        return 1;
+    if(nb_tiles == 2)
+        return is_partial && (GetPairCompletions(set.one) & table_tiles) ? 1 : 2;
+    return IsSetValidWithoutOneTile(set) || (GetRunHole(set) & table_tiles) ? 1 : 2;
+}
+
+// Each illegal set needs its deficit of moves changing it and a move changes at most two sets, so the
+// moves left are at least the largest deficit and half the sum of the deficits
+float DeficitHeuristic(const struct TableState_s* table_state)
+{
+    int deficit = 0;
+    int max_deficit = 0;
+    uint64_t table_tiles = GetTableStateTiles(table_state).one;
+    uint64_t illegal_sets = table_state->illegal_sets;
+    while(illegal_sets)
+    {
+        int i = __builtin_ctzll(illegal_sets);
+        illegal_sets &= illegal_sets - 1;
+        bool is_partial = table_state->partial_sets & (1ULL << i);
+        int set_deficit = GetIllegalSetDeficit(table_state->sets[i], is_partial, table_tiles);
+        deficit += set_deficit;
+        if(set_deficit > max_deficit)
+            max_deficit = set_deficit;
+    }
+    int bound = (deficit + 1) / 2;
+    return (float)(bound > max_deficit ? bound : max_deficit);
+}
+
+// Heuristics of the A* search with the name used to choose them
+static const struct {
+    const char* name;
+    Heuristic_f function;
+} heuristics[] = {
+    {"partial", heuristic},
+    {"illegal", IllegalSetsHeuristic},
+    {"deficit", DeficitHeuristic}
+};
+
+// Return the heuristic of the given name or NULL if it does not exist
+Heuristic_f GetHeuristicFromName(const char* name)
+{
+    for(size_t i = 0; i < sizeof(heuristics) / sizeof(heuristics[0]); i++)
+    {
+        if(!strcmp(heuristics[i].name, name))
+            return heuristics[i].function;
+    }
+    return NULL;
+}
+
+// Return the index of a heuristic in the heuristics table or -1 if it is not there
+int GetHeuristicIndex(Heuristic_f function)
+{
+    for(size_t i = 0; i < sizeof(heuristics) / sizeof(heuristics[0]); i++)
+    {
+        if(heuristics[i].function == function)
+            return (int)i;
+    }
+    return -1;
+}
+
+const char* GetHeuristicName(Heuristic_f function)
+{
+    for(size_t i = 0; i < sizeof(heuristics) / sizeof(heuristics[0]); i++)
+    {
+        if(heuristics[i].function == function)
+            return heuristics[i].name;
+    }
+    return "unknown";
+}
+
+// Create a priority queue node in the arena of the search, its heuristic is set by the search that queues it.
+// With a base node the table is stored as the sets changed since the changed mask of the table was cleared,
+// which must have been when the table was the table of the base. Return NULL when the arena is out of memory
+struct PriorityQueue_s* CreatePriorityQueueFromBase(struct Arena_s* arena, const struct TableState_s* table_state, const struct PriorityQueue_s* base, struct PriorityQueue_s* previous_queue, int depth)
+{
+    uint64_t all_sets = table_state->nb_sets == 64 ? ~0ULL : (1ULL << table_state->nb_sets) - 1;
+    uint64_t stored_sets = table_state->changed_sets & all_sets;
+    if(base && (__builtin_popcountll(stored_sets) > MAX_NODE_CHANGED_SETS || base->chain_length >= MAX_NODE_CHAIN_LENGTH))
+        base = NULL;
+    if(!base)
+        stored_sets = all_sets;
+    int nb_stored_sets = __builtin_popcountll(stored_sets);
+    struct PriorityQueue_s* queue = ArenaAlloc(arena, sizeof(struct PriorityQueue_s) + nb_stored_sets * sizeof(struct TileBitboard_s));
+    if(!queue)
+        return NULL;
+    queue->base = base;
+    queue->chain_length = base ? base->chain_length + 1 : 0;
+    queue->nb_sets = table_state->nb_sets;
+    queue->hash = table_state->hash;
+    queue->illegal_sets = table_state->illegal_sets;
+    queue->partial_sets = table_state->partial_sets;
+    queue->empty_sets = table_state->empty_sets;
+    queue->stored_sets = stored_sets;
+    for(int i = 0; stored_sets; i++)
+    {
+        int set_index = __builtin_ctzll(stored_sets);
+        stored_sets &= stored_sets - 1;
+        queue->sets[i] = table_state->sets[set_index];
+    }
+    queue->h = 0;
+    queue->g = depth;
+    queue->heap_index = -1;
+    queue->order = 0;
+    queue->previous_set = previous_queue;
+    return queue;
+}
+
+// Create a priority queue node storing every set of its table
+struct PriorityQueue_s* CreatePriorityQueue(struct Arena_s* arena, const struct TableState_s* table_state, struct PriorityQueue_s* previous_queue, int depth)
+{
+    return CreatePriorityQueueFromBase(arena, table_state, NULL, previous_queue, depth);
+}
+
+// Rebuild the sets of a node from the sets stored along its chain of bases
+static void GetPriorityQueueSets(const struct PriorityQueue_s* queue, struct TableState_s* table_state)
+{
+    if(queue->base)
+        GetPriorityQueueSets(queue->base, table_state);
+    uint64_t stored_sets = queue->stored_sets;
+    for(int i = 0; stored_sets; i++)
+    {
+        int set_index = __builtin_ctzll(stored_sets);
+        stored_sets &= stored_sets - 1;
+        table_state->sets[set_index] = queue->sets[i];
+    }
+}
+
+// Rebuild the table of a node and its tile masks, the changed mask is cleared
+void GetPriorityQueueTableState(const struct PriorityQueue_s* queue, struct TableState_s* table_state)
+{
+    GetPriorityQueueSets(queue, table_state);
+    table_state->nb_sets = queue->nb_sets;
+    table_state->hash = queue->hash;
+    table_state->illegal_sets = queue->illegal_sets;
+    table_state->partial_sets = queue->partial_sets;
+    table_state->empty_sets = queue->empty_sets;
+    table_state->changed_sets = 0;
+    IndexTableStateTiles(table_state);
+}
+
+void InitPriorityQueue(struct PriorityQueueHeap_s* queue)
+{
+    *queue = (struct PriorityQueueHeap_s){NULL, 0, 0, 0};
+}
+
+// Free the heap array, the nodes belong to the arena of their search
+void ClearPriorityQueue(struct PriorityQueueHeap_s* queue)
+{
+    free(queue->nodes);
+    InitPriorityQueue(queue);
+}
+
+// Remove every node from the heap and keep the array for the next search
+void EmptyPriorityQueue(struct PriorityQueueHeap_s* queue)
+{
+    queue->size = 0;
+    queue->next_order = 0;
+}
+
+bool IsPriorityQueueEmpty(const struct PriorityQueueHeap_s* queue)
+{
+    return queue->size == 0;
+}
+
+// Lowest f = g + h first, on equal f the node inserted first comes first so results are reproducible
+static bool IsPriorityQueueNodeBefore(const struct PriorityQueue_s* a, const struct PriorityQueue_s* b)
+{
+    float f_a = (float)(a->g + a->h);
+    float f_b = (float)(b->g + b->h);
+    if(f_a != f_b)
+        return f_a < f_b;
+    return a->order < b->order;
+}
+
+static void SetPriorityQueueNode(struct PriorityQueueHeap_s* queue, int index, struct PriorityQueue_s* node)
+{
+    queue->nodes[index] = node;
+    node->heap_index = index;
+}
+
+static void SiftUpPriorityQueue(struct PriorityQueueHeap_s* queue, int index)
+{
+    struct PriorityQueue_s* node = queue->nodes[index];
+    while(index > 0)
+    {
+        int parent = (index - 1) / 2;
+        if(!IsPriorityQueueNodeBefore(node, queue->nodes[parent]))
+            break;
+        SetPriorityQueueNode(queue, index, queue->nodes[parent]);
+        index = parent;
+    }
+    SetPriorityQueueNode(queue, index, node);
+}
+
+static void SiftDownPriorityQueue(struct PriorityQueueHeap_s* queue, int index)
+{
+    struct PriorityQueue_s* node = queue->nodes[index];
+    while(true)
+    {
+        int child = 2 * index + 1;
+        if(child >= queue->size)
+            break;
+        if(child + 1 < queue->size && IsPriorityQueueNodeBefore(queue->nodes[child + 1], queue->nodes[child]))
+            child++;
+        if(!IsPriorityQueueNodeBefore(queue->nodes[child], node))
+            break;
+        SetPriorityQueueNode(queue, index, queue->nodes[child]);
+        index = child;
+    }
+    SetPriorityQueueNode(queue, index, node);
+}
+
+// Queue a node, return false when the heap cannot grow
+bool AddToPriorityQueue(struct PriorityQueueHeap_s* queue, struct PriorityQueue_s* new_queue)
+{
+    if(queue->size == queue->capacity)
+    {
+        int capacity = queue->capacity ? queue->capacity * 2 : 128;
+        struct PriorityQueue_s** nodes = realloc(queue->nodes, capacity * sizeof(struct PriorityQueue_s*));
+        if(!nodes)
+            return false;
+        queue->nodes = nodes;
+        queue->capacity = capacity;
+    }
+    new_queue->order = queue->next_order++;
+    SetPriorityQueueNode(queue, queue->size++, new_queue);
+    SiftUpPriorityQueue(queue, new_queue->heap_index);
+    return true;
+}
+
+struct PriorityQueue_s* PopFromPriorityQueue(struct PriorityQueueHeap_s* queue)
+{
+    if(!queue || !queue->size)
+        return NULL;
+    struct PriorityQueue_s* current = queue->nodes[0];
+    queue->size--;
+    if(queue->size)
+    {
+        SetPriorityQueueNode(queue, 0, queue->nodes[queue->size]);
+        SiftDownPriorityQueue(queue, 0);
+    }
+    current->heap_index = -1;
+    return current;
+}
+
+// Give a queued node a shorter path, the node keeps its insertion order
+void DecreasePriorityQueueKey(struct PriorityQueueHeap_s* queue, struct PriorityQueue_s* node, int g, struct PriorityQueue_s* previous_queue)
+{
+    if(node->heap_index < 0 || g >= node->g)
+        return;
+    node->g = g;
+    node->previous_set = previous_queue;
+    SiftUpPriorityQueue(queue, node->heap_index);
+}
+
+// Get shortest non valid set 
+int GetShortestNonValidSet(const struct TableState_s* table_state)
+{
+    int min_number = INT_MAX;
+    int min_set = -1;
+    // Only the illegal sets are visited, a searched table has very few of them
+    uint64_t illegal_sets = table_state->illegal_sets;
+    while(illegal_sets)
+    {
+        int i = __builtin_ctzll(illegal_sets);
+        illegal_sets &= illegal_sets - 1;
+        int number = GetBitboardTilesNumber(table_state->sets[i]);
+        if(number < min_number)
+        {
+            min_number = number;
+            min_set = i;
+        }
+    }
+    return min_set;
+}
+
+// Store in bits the tiles completing a group with the tiles of the given number, return the new number of tiles
+int AddGroupCompletionTiles(struct TileBitboard_s illegal_set, int number_bit, int* bits, int nb_bits)
+{
+    for(int color = 0; color < NB_COLORS; color++)
+    {
+        int bit = color * COLOR_LANE_BITS + number_bit;
+        if(!(illegal_set.one & (1ULL << bit)))
+            bits[nb_bits++] = bit;
+    }
+    return nb_bits;
+}
+
+// Store in bits the tiles that can be added before the first tile of the illegal set, return their number.
+// The sets holding each tile are found in the tile masks of the table
+int wichTilesCanAddOnStart(const struct TableState_s* table_state, int illegal_index, int bits[MAX_EXTENSION_TILES])
+{
+    struct TileBitboard_s illegal_set = table_state->sets[illegal_index];
+    int nb_bits = 0;
+    int first_bit = GetBitboardLowestBit(illegal_set);
+    // if the first tile of the illegal set is superior to 1 we can complete it with 2, 3, 4...
+    if(GetBitNumber(first_bit) > 1)
+        bits[nb_bits++] = first_bit - 1;
+
+    if(GetBitboardTilesNumber(illegal_set) < 4)
+        nb_bits = AddGroupCompletionTiles(illegal_set, first_bit % COLOR_LANE_BITS, bits, nb_bits);
+
+    return nb_bits;
+}
+
+// Store in bits the tiles that can be added after the last tile of the illegal set, return their number
+int wichTilesCanAddOnEnd(const struct TableState_s* table_state, int illegal_index, int bits[MAX_EXTENSION_TILES])
+{
+    struct TileBitboard_s illegal_set = table_state->sets[illegal_index];
+    int nb_bits = 0;
+    int last_bit = GetBitboardHighestBit(illegal_set);
+    // if the last tile of the illegal set is inferior to 13 we can complete it with 12, 11, 10...
+    if(GetBitNumber(last_bit) < NB_NUMBERS)
+        bits[nb_bits++] = last_bit + 1;
+
+    // The group of the first number is already completed on start
+    int first_bit = GetBitboardLowestBit(illegal_set);
+    if(GetBitboardTilesNumber(illegal_set) < 4 && (first_bit % COLOR_LANE_BITS) != (last_bit % COLOR_LANE_BITS))
+        nb_bits = AddGroupCompletionTiles(illegal_set, last_bit % COLOR_LANE_BITS, bits, nb_bits);
+
+    return nb_bits;
+}
+
+// Store in moves the moves on the illegal set of a table, in the order the search tries them, return their number
+int GetTableMoves(const struct TableState_s* table_state, int illegal_index, struct TableMove_s* moves)
+{
+    struct TileBitboard_s illegal_set = table_state->sets[illegal_index];
+    int nb_moves = 0;
+    // Take each tile from the illegal set and try to concatenate it with every other set
+    uint64_t tiles = illegal_set.one;
+    while(tiles)
+    {
+        int bit = __builtin_ctzll(tiles);
+        tiles &= tiles - 1;
+        // The move is kept if the created set is semi legal
+        uint64_t sets = GetSetsTakingTile(table_state, bit) & ~(1ULL << illegal_index);
+        while(sets)
+        {
+            moves[nb_moves++] = (struct TableMove_s){MOVE_TO_SET, bit, __builtin_ctzll(sets)};
+            sets &= sets - 1;
+        }
+    }
+
+    // Get tiles in table sets that can be added at the start then at the end of the illegal set
+    int extension_bits[MAX_EXTENSION_TILES];
+    for(int side = 0; side < 2; side++)
+    {
+        int nb_bits = side == 0 ? wichTilesCanAddOnStart(table_state, illegal_index, extension_bits)
+                                : wichTilesCanAddOnEnd(table_state, illegal_index, extension_bits);
+        for(int idx = 0; idx < nb_bits; idx++)
+        {
+            int bit = extension_bits[idx];
+            uint64_t tile_sets = table_state->tile_sets[bit] & ~(1ULL << illegal_index);
+            while(tile_sets)
+            {
+                moves[nb_moves++] = (struct TableMove_s){side == 0 ? MOVE_ON_START : MOVE_ON_END, bit, __builtin_ctzll(tile_sets)};
+                tile_sets &= tile_sets - 1;
+            }
+        }
+    }
+
+    //If the illegal set contains 2 tiles, split it in 2 sets
+    if(GetBitboardTilesNumber(illegal_set) == 2)
+        moves[nb_moves++] = (struct TableMove_s){MOVE_SPLIT, GetBitboardLowestBit(illegal_set), illegal_index};
+    return nb_moves;
+}
+
+// Number of moves counted for a move by the search
+int GetTableMoveCost(struct TableMove_s move)
+{
+    return move.kind == MOVE_SPLIT ? 2 : 1;
+}
+
+// Play a move on the illegal set of a table, the sets it empties are kept.
+// Return false if the table cannot hold the sets created by the move
+bool PlayTableMove(struct TableState_s* table_state, int illegal_index, struct TableMove_s move)
+{
+    switch(move.kind)
+    {
+        case MOVE_TO_SET:
+            RemoveBitFromTableSet(table_state, illegal_index, move.bit);
+            return AddBitToTableSet(table_state, move.set_index, move.bit);
+        case MOVE_ON_START:
+        case MOVE_ON_END:
+            // Remove the tile from where it was and add it to the illegal set
+            if(!TakeTileFromTableSet(table_state, move.set_index, move.bit))
+                return false;
+            return AddBitToTableSet(table_state, illegal_index, move.bit);
+        default:
+            RemoveBitFromTableSet(table_state, illegal_index, move.bit);
+            return AddSetToTableState(table_state, (struct TileBitboard_s){1ULL << move.bit, 0});
+    }
+}
+
+// Save the sets of a table that a move on its illegal set overwrites
+void SaveTableMove(const struct TableState_s* table_state, int illegal_index, struct TableMove_s move, struct TableUndo_s* undo)
+{
+    undo->nb_sets = table_state->nb_sets;
+    undo->set_indexes[0] = illegal_index;
+    undo->set_indexes[1] = move.set_index;
+    undo->sets[0] = table_state->sets[illegal_index];
+    undo->sets[1] = table_state->sets[move.set_index];
+}
+
+// Take back a move saved by SaveTableMove, whether it was played entirely or not
+void UndoTableMove(struct TableState_s* table_state, const struct TableUndo_s* undo)
+{
+    while(table_state->nb_sets > undo->nb_sets)
+        RemoveLastSetFromTableState(table_state);
+    SetTableStateSet(table_state, undo->set_indexes[1], undo->sets[1]);
+    SetTableStateSet(table_state, undo->set_indexes[0], undo->sets[0]);
+}
+
+// Allocate a transposition table of 2^TRANSPOSITION_TABLE_BITS entries, return false if the allocation failed
+bool CreateTranspositionTable(struct TranspositionTable_s* transpositions)
+{
+    transpositions->entries = calloc(1ULL << TRANSPOSITION_TABLE_BITS, sizeof(struct TranspositionEntry_s));
+    transpositions->mask = ((1ULL << TRANSPOSITION_TABLE_BITS) - 1) & ~(uint64_t)(TRANSPOSITION_BUCKET_SIZE - 1);
+    transpositions->generation = 1;
+    return transpositions->entries != NULL;
+}
+
+void FreeTranspositionTable(struct TranspositionTable_s* transpositions)
+{
+    free(transpositions->entries);
+    transpositions->entries = NULL;
+}
+
+// Forget every table state stored, the entries of the previous generations become free
+void ClearTranspositionTable(struct TranspositionTable_s* transpositions)
+{
+    transpositions->generation++;
+    if(transpositions->generation == 0)
+    {
+        memset(transpositions->entries, 0, (1ULL << TRANSPOSITION_TABLE_BITS) * sizeof(struct TranspositionEntry_s));
+        transpositions->generation = 1;
+    }
+}
+
+// Return the entry of a table state hash, NULL if the table state was not reached since the last clear
+struct TranspositionEntry_s* ProbeTranspositionTable(struct TranspositionTable_s* transpositions, uint64_t hash)
+{
+    struct TranspositionEntry_s* bucket = &transpositions->entries[hash & transpositions->mask];
+    for(int i = 0; i < TRANSPOSITION_BUCKET_SIZE; i++)
+    {
+        if(bucket[i].generation == transpositions->generation && bucket[i].hash == hash)
+            return &bucket[i];
+    }
+    return NULL;
+}
+
+// Store a table state in a free entry of its bucket, or in place of the entry with the longest path
+void StoreTranspositionTable(struct TranspositionTable_s* transpositions, uint64_t hash, int g, struct PriorityQueue_s* node)
+{
+    struct TranspositionEntry_s* bucket = &transpositions->entries[hash & transpositions->mask];
+    struct TranspositionEntry_s* entry = &bucket[0];
+    for(int i = 0; i < TRANSPOSITION_BUCKET_SIZE; i++)
+    {
+        if(bucket[i].generation != transpositions->generation || bucket[i].hash == hash)
+        {
+            entry = &bucket[i];
+            break;
+        }
+        if(bucket[i].g > entry->g)
+            entry = &bucket[i];
+    }
+    *entry = (struct TranspositionEntry_s){hash, node, g, transpositions->generation};
+}
+
+#ifdef RUMMIKUB_STATS
+// Cycle counter of the processor, nanoseconds of the monotonic clock when there is none
+static inline uint64_t ReadCycleCounter()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+#endif
+
+// Monotonic clock time in nanoseconds
+static uint64_t GetMonotonicNanoseconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+// Return true once the deadline of the search passed, the clock is only read every DEADLINE_CHECK_NODES nodes
+static bool IsSearchExpired(struct AStarSearch_s* search)
+{
+    if(search->deadline_ns && !search->expired && !(search->stats.nb_nodes % DEADLINE_CHECK_NODES))
+        search->expired = GetMonotonicNanoseconds() >= search->deadline_ns;
+    return search->expired;
+}
+
+// Stop the search after a failed allocation, the solve reports the failure
+static void SetSearchOutOfMemory(struct AStarSearch_s* search)
+{
+    search->out_of_memory = true;
+    search->expired = true;
+}
+
+// Transposition key of a table, shared by the tables that the symmetries of the search map to each other
+static uint64_t GetSearchTableHash(const struct AStarSearch_s* search, const struct TableState_s* table_state)
+{
+    if(!search->nb_symmetries)
+        return table_state->hash;
+    return GetSymmetricTableHash(table_state, search->symmetries, search->nb_symmetries);
+}
+
+// Add a table state to the priority queue, table states already reached with a path as short are skipped
+void PushTableState(struct AStarSearch_s* search, const struct TableState_s* table_state, struct PriorityQueue_s* previous_queue, int depth)
+{
+    // The successors are made from the table of the previous node, they only store the sets of their move
+    struct SearchStats_s* stats = &search->stats;
+    STATS_TIMER_START(TIMER_INSERTION);
+    uint64_t hash = GetSearchTableHash(search, table_state);
+    struct TranspositionEntry_s* entry = ProbeTranspositionTable(&search->transpositions, hash);
+    if(entry)
+    {
+        if(entry->g <= depth)
+        {
+            STATS_ADD(stats, duplicates, 1);
+            STATS_TIMER_STOP(stats, TIMER_INSERTION);
+            return;
+        }
+        // The table state is still waiting in the queue, give it the shorter path
+        if(entry->node && entry->node->heap_index >= 0)
+        {
+            DecreasePriorityQueueKey(&search->queue, entry->node, depth, previous_queue);
+            entry->g = depth;
+            STATS_ADD(stats, reopened, 1);
+            STATS_TIMER_STOP(stats, TIMER_INSERTION);
+            return;
+        }
+    }
+    STATS_TIMER_STOP(stats, TIMER_INSERTION);
+    STATS_TIMER_START(TIMER_HEURISTIC);
+    float h = search->heuristic(table_state);
+    STATS_TIMER_STOP(stats, TIMER_HEURISTIC);
+    // The heuristic is a lower bound of the moves left, skip the tables that cannot be resolved by a node
+    // that is still expanded
+    if(h > 0 && (depth > search->max_depth || depth + h > search->max_depth + MAX_MOVE_COST))
+    {
+        STATS_ADD(stats, pruned, 1);
+        return;
+    }
+    STATS_TIMER_START(TIMER_COPY);
+    struct PriorityQueue_s* new_queue = CreatePriorityQueueFromBase(&search->arena, table_state, previous_queue, previous_queue, depth);
+    STATS_TIMER_STOP(stats, TIMER_COPY);
+    if(!new_queue)
+    {
+        SetSearchOutOfMemory(search);
+        return;
+    }
+    new_queue->h = h;
+    STATS_TIMER_RESUME(TIMER_INSERTION);
+    if(!AddToPriorityQueue(&search->queue, new_queue))
+    {
+        SetSearchOutOfMemory(search);
+        STATS_TIMER_STOP(stats, TIMER_INSERTION);
+        return;
+    }
+    StoreTranspositionTable(&search->transpositions, hash, depth, new_queue);
+    STATS_MAX(stats, peak_frontier, search->queue.size);
+    STATS_TIMER_STOP(stats, TIMER_INSERTION);
+}
+
+// Search the moves that make every set of the queued table valid, the nodes are allocated in the arena
+// of the search and its counters are added to the search stats
+struct PriorityQueue_s* ResolvedTileset(struct AStarSearch_s* search)
+{
+    struct PriorityQueueHeap_s* queue = &search->queue;
+    struct SearchStats_s* stats = &search->stats;
+    struct TableState_s table_sets;
+    struct TableState_s best_state;
+    struct TableMove_s moves[MAX_TABLE_MOVES];
+    // While the priority queu is not empty
+    while(!IsPriorityQueueEmpty(queue))
+    {
+        // Pop the first element of the queue, wich is one table tile set after certain moves
+        struct PriorityQueue_s* best = PopFromPriorityQueue(queue);
+        stats->nb_nodes++;
+        if(IsSearchExpired(search))
+            return NULL;
+        // If there is no illegal set the table is resolved
+        if(!best->illegal_sets)
+        {
+            return best;
+        }
+        // If the search limit was exceed
+        if(best->g > search->max_depth)
+        {
+            return NULL;
+        }
+        STATS_TIMER_START(TIMER_COPY);
+        GetPriorityQueueTableState(best, &best_state);
+        STATS_TIMER_STOP(stats, TIMER_COPY);
+        // Get the shortest non valid set from the table and the moves on it
+        STATS_TIMER_START(TIMER_VALIDITY);
+        int illegal_index = GetShortestNonValidSet(&best_state);
+        int nb_moves = GetTableMoves(&best_state, illegal_index, moves);
+        STATS_TIMER_STOP(stats, TIMER_VALIDITY);
+        for(int i = 0; i < nb_moves; i++)
+        {
+            STATS_TIMER_START(TIMER_COPY);
+            table_sets = best_state;
+            STATS_TIMER_STOP(stats, TIMER_COPY);
+            if(!PlayTableMove(&table_sets, illegal_index, moves[i]))
+                continue;
+            RemoveEmptySetsFromTableState(&table_sets);
+            // Add the new table states to the priority queue
+            STATS_ADD(stats, successors[moves[i].kind], 1);
+            PushTableState(search, &table_sets, best, best->g + GetTableMoveCost(moves[i]));
+        }
+    }
+    return NULL;
+}
+
+// Node of the path found by IDA*, storing the table without the sets emptied by the moves
+static struct PriorityQueue_s* CreateIDAStarNode(struct AStarSearch_s* search, const struct TableState_s* table_state, int depth)
+{
+    struct TableState_s compact_state = *table_state;
+    RemoveEmptySetsFromTableState(&compact_state);
+    struct PriorityQueue_s* node = CreatePriorityQueue(&search->arena, &compact_state, NULL, depth);
+    if(!node)
+        SetSearchOutOfMemory(search);
+    return node;
+}
+
+// Depth first search of IDA* from a table reached after depth moves, bounded by f = g + h. The moves are
+// played and taken back on the table. Return the resolved node linked to the path from the table, or NULL
+// after lowering next_bound to the smallest f that exceeded the bound
+static struct PriorityQueue_s* IDAStarVisit(struct AStarSearch_s* search, struct TableState_s* table_state, int depth, float bound, float* next_bound)
+{
+    struct SearchStats_s* stats = &search->stats;
+    stats->nb_nodes++;
+    if(IsSearchExpired(search))
+        return NULL;
+    if(!table_state->illegal_sets)
+        return CreateIDAStarNode(search, table_state, depth);
+    if(depth > search->max_depth)
+        return NULL;
+    struct TableMove_s moves[MAX_TABLE_MOVES];
+    STATS_TIMER_START(TIMER_VALIDITY);
+    int illegal_index = GetShortestNonValidSet(table_state);
+    int nb_moves = GetTableMoves(table_state, illegal_index, moves);
+    STATS_TIMER_STOP(stats, TIMER_VALIDITY);
+    for(int i = 0; i < nb_moves; i++)
+    {
+        struct TableUndo_s undo;
+        struct PriorityQueue_s* resolved = NULL;
+        int new_depth = depth + GetTableMoveCost(moves[i]);
+        SaveTableMove(table_state, illegal_index, moves[i], &undo);
+        if(PlayTableMove(table_state, illegal_index, moves[i]))
+        {
+            STATS_ADD(stats, successors[moves[i].kind], 1);
+            STATS_TIMER_START(TIMER_HEURISTIC);
+            float h = search->heuristic(table_state);
+            STATS_TIMER_STOP(stats, TIMER_HEURISTIC);
+            // Same pruning as the A* search
+            if(h > 0 && (new_depth > search->max_depth || new_depth + h > search->max_depth + MAX_MOVE_COST))
+                STATS_ADD(stats, pruned, 1);
+            else if(new_depth + h > bound)
+            {
+                if(new_depth + h < *next_bound)
+                    *next_bound = new_depth + h;
+            }
+            else
+                resolved = IDAStarVisit(search, table_state, new_depth, bound, next_bound);
+        }
+        UndoTableMove(table_state, &undo);
+        if(resolved)
+        {
+            // Link the path found to the table it starts from
+            struct PriorityQueue_s* first = resolved;
+            while(first->previous_set)
+                first = first->previous_set;
+            first->previous_set = CreateIDAStarNode(search, table_state, depth);
+            return first->previous_set ? resolved : NULL;
+        }
+    }
+    return NULL;
+}
+
+// Resolve a table with IDA*, only the path being searched is kept in memory. The bound starts at the heuristic
+// of the table and is raised to the smallest f that exceeded it until the table is resolved or nothing exceeded it
+struct PriorityQueue_s* ResolvedTilesetIDAStar(struct AStarSearch_s* search, struct TableState_s* table_state)
+{
+    float bound = search->heuristic(table_state);
+    while(true)
+    {
+        float next_bound = FLT_MAX;
+        struct PriorityQueue_s* resolved = IDAStarVisit(search, table_state, 0, bound, &next_bound);
+        if(resolved || next_bound == FLT_MAX || search->expired)
+            return resolved;
+        bound = next_bound;
+    }
+}
+
+struct PriorityQueue_s* CopyPriorityQueue(struct Arena_s* arena, struct PriorityQueue_s* queue)
+{
+    struct TableState_s table_state;
+    GetPriorityQueueTableState(queue, &table_state);
+    struct PriorityQueue_s* new_queue = CreatePriorityQueue(arena, &table_state, NULL, queue->g);
+    return new_queue;
+}
+
+// Return the number of threads used when none is given : one per online processor
+int GetDefaultThreadCount()
+{
+    long nb_processors = sysconf(_SC_NPROCESSORS_ONLN);
+    if(nb_processors < 1)
+        return 1;
+    return nb_processors > MAX_SOLVER_THREADS ? MAX_SOLVER_THREADS : (int)nb_processors;
+}
+
+// Take the next candidate of the worker, or steal the second half of the candidates left to another worker
+static bool TakeAStarCandidate(struct AStarWorker_s* worker, int* index)
+{
+    struct AStarPool_s* pool = worker->pool;
+    pthread_mutex_lock(&worker->lock);
+    if(worker->next < worker->end)
+    {
+        *index = worker->next++;
+        pthread_mutex_unlock(&worker->lock);
+        return true;
+    }
+    pthread_mutex_unlock(&worker->lock);
+
+    for(int i = 1; i < pool->nb_workers; i++)
+    {
+        struct AStarWorker_s* victim = &pool->workers[(worker->index + i) % pool->nb_workers];
+        pthread_mutex_lock(&victim->lock);
+        int left = victim->end - victim->next;
+        if(left <= 0)
+        {
+            pthread_mutex_unlock(&victim->lock);
+            continue;
+        }
+        int end = victim->end;
+        int start = end - (left + 1) / 2;
+        victim->end = start;
+        pthread_mutex_unlock(&victim->lock);
+
+        pthread_mutex_lock(&worker->lock);
+        worker->next = start + 1;
+        worker->end = end;
+        pthread_mutex_unlock(&worker->lock);
+        *index = start;
+        return true;
+    }
+    return false;
+}
+
+// Put the rack tile of the candidate in its table set and resolve the table, the result is copied
+// in the moves arena of the worker
+static void RunAStarCandidate(struct AStarWorker_s* worker, int index)
+{
+    struct AStarPool_s* pool = worker->pool;
+    const struct AStarCandidate_s* candidate = &pool->candidates[index];
+    struct AStarResult_s* result = &pool->results[index];
+    result->state = NULL;
+
+    // The candidates left when the deadline passed are not searched
+    struct AStarSearch_s* search = &worker->search;
+    if(search->deadline_ns && !search->expired)
+        search->expired = GetMonotonicNanoseconds() >= search->deadline_ns;
+    if(search->expired)
+        return;
+
+    struct TableState_s start_state = *pool->table_state;
+    if(candidate->set_index == start_state.nb_sets && !AddSetToTableState(&start_state, (struct TileBitboard_s){0, 0}))
+        return;
+    if(!AddBitToTableSet(&start_state, candidate->set_index, candidate->bit))
+        return;
+    ResetArena(&search->arena);
+    search->nb_symmetries = GetColorSymmetries(GetTableStateTiles(&start_state), search->symmetries);
+    struct PriorityQueue_s* resolved_set;
+    if(search->iterative_deepening)
+        resolved_set = ResolvedTilesetIDAStar(search, &start_state);
+    else
+    {
+        EmptyPriorityQueue(&search->queue);
+        ClearTranspositionTable(&search->transpositions);
+        struct PriorityQueue_s* start_queue = CreatePriorityQueue(&search->arena, &start_state, NULL, 0);
+        if(!start_queue || !AddToPriorityQueue(&search->queue, start_queue))
+        {
+            SetSearchOutOfMemory(search);
+            return;
+        }
+        StoreTranspositionTable(&search->transpositions, GetSearchTableHash(search, &start_state), 0, start_queue);
+        resolved_set = ResolvedTileset(search);
+    }
+
+    if(resolved_set)
+    {
+        result->state = CopyPriorityQueue(&worker->moves_arena, resolved_set);
+        if(!result->state)
+            SetSearchOutOfMemory(search);
+    }
+}
+
+static void RunAStarCandidates(struct AStarWorker_s* worker)
+{
+    int index;
+    while(TakeAStarCandidate(worker, &index))
+        RunAStarCandidate(worker, index);
+}
+
+// Thread of a worker : run the candidates of each layer until the pool stops
+static void* AStarWorkerThread(void* argument)
+{
+    struct AStarWorker_s* worker = argument;
+    struct AStarPool_s* pool = worker->pool;
+    unsigned long layer = 0;
+    pthread_mutex_lock(&pool->lock);
+    while(true)
+    {
+        while(!pool->stop && pool->layer == layer)
+            pthread_cond_wait(&pool->layer_started, &pool->lock);
+        if(pool->stop)
+            break;
+        layer = pool->layer;
+        pthread_mutex_unlock(&pool->lock);
+
+        RunAStarCandidates(worker);
+
+        pthread_mutex_lock(&pool->lock);
+        if(--pool->nb_running == 0)
+            pthread_cond_signal(&pool->layer_done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+static bool InitAStarWorker(struct AStarPool_s* pool, int index, const struct SolverOptions_s* options)
+{
+    struct AStarWorker_s* worker = &pool->workers[index];
+    worker->pool = pool;
+    worker->index = index;
+    worker->next = 0;
+    worker->end = 0;
+    worker->search.stats = (struct SearchStats_s){0};
+    worker->search.heuristic = options->heuristic;
+    worker->search.max_depth = options->max_depth;
+    worker->search.iterative_deepening = options->iterative_deepening;
+    worker->search.deadline_ns = 0;
+    worker->search.expired = false;
+    worker->search.out_of_memory = false;
+    worker->search.transpositions.entries = NULL;
+    if(!options->iterative_deepening && !CreateTranspositionTable(&worker->search.transpositions))
+        return false;
+    InitArena(&worker->moves_arena);
+    InitArena(&worker->search.arena);
+    InitPriorityQueue(&worker->search.queue);
+    pthread_mutex_init(&worker->lock, NULL);
+    return true;
+}
+
+static void FreeAStarWorker(struct AStarWorker_s* worker)
+{
+    pthread_mutex_destroy(&worker->lock);
+    ClearPriorityQueue(&worker->search.queue);
+    FreeArena(&worker->search.arena);
+    FreeArena(&worker->moves_arena);
+    FreeTranspositionTable(&worker->search.transpositions);
+}
+
+// Create the workers of the pool, fewer threads are used when a thread cannot be created
+bool InitAStarPool(struct AStarPool_s* pool, const struct SolverOptions_s* options)
+{
+    int nb_threads = options->nb_threads;
+    if(nb_threads < 1)
+        nb_threads = 1;
+    if(nb_threads > MAX_SOLVER_THREADS)
+        nb_threads = MAX_SOLVER_THREADS;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->layer_started, NULL);
+    pthread_cond_init(&pool->layer_done, NULL);
+    pool->layer = 0;
+    pool->nb_running = 0;
+    pool->stop = false;
+    pool->nb_workers = 0;
+    if(!InitAStarWorker(pool, 0, options))
+        return false;
+    pool->nb_workers = 1;
+    while(pool->nb_workers < nb_threads)
+    {
+        struct AStarWorker_s* worker = &pool->workers[pool->nb_workers];
+        if(!InitAStarWorker(pool, pool->nb_workers, options))
+            break;
+        if(pthread_create(&worker->thread, NULL, AStarWorkerThread, worker))
+        {
+            FreeAStarWorker(worker);
+            break;
+        }
+        pool->nb_workers++;
+    }
+    return true;
+}
+
+// Stop the threads of the pool and free the memory of the workers, the results of the layers are freed too
+void FreeAStarPool(struct AStarPool_s* pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->layer_started);
+    pthread_mutex_unlock(&pool->lock);
+    for(int i = 0; i < pool->nb_workers; i++)
+    {
+        if(i)
+            pthread_join(pool->workers[i].thread, NULL);
+        FreeAStarWorker(&pool->workers[i]);
+    }
+    pthread_cond_destroy(&pool->layer_done);
+    pthread_cond_destroy(&pool->layer_started);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+// Run every candidate of a layer, the candidates are shared evenly between the workers before stealing
+void RunAStarLayer(struct AStarPool_s* pool, const struct TableState_s* table_state, const struct AStarCandidate_s* candidates, struct AStarResult_s* results, int nb_candidates)
+{
+    pool->table_state = table_state;
+    pool->candidates = candidates;
+    pool->results = results;
+    pool->nb_candidates = nb_candidates;
+    for(int i = 0; i < pool->nb_workers; i++)
+    {
+        struct AStarWorker_s* worker = &pool->workers[i];
+        pthread_mutex_lock(&worker->lock);
+        worker->next = (int)((long)nb_candidates * i / pool->nb_workers);
+        worker->end = (int)((long)nb_candidates * (i + 1) / pool->nb_workers);
+        pthread_mutex_unlock(&worker->lock);
+    }
+    if(pool->nb_workers > 1)
+    {
+        pthread_mutex_lock(&pool->lock);
+        pool->nb_running = pool->nb_workers - 1;
+        pool->layer++;
+        pthread_cond_broadcast(&pool->layer_started);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    RunAStarCandidates(&pool->workers[0]);
+
+    if(pool->nb_workers > 1)
+    {
+        pthread_mutex_lock(&pool->lock);
+        while(pool->nb_running > 0)
+            pthread_cond_wait(&pool->layer_done, &pool->lock);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+// Prepare the workers of a pool for a new solve, their memory is kept
+static void ResetAStarPool(struct AStarPool_s* pool, uint64_t deadline_ns)
+{
+    for(int i = 0; i < pool->nb_workers; i++)
+    {
+        struct AStarWorker_s* worker = &pool->workers[i];
+        ResetArena(&worker->moves_arena);
+        worker->moves_arena.allocated = 0;
+        worker->search.arena.allocated = 0;
+        worker->search.stats = (struct SearchStats_s){0};
+        worker->search.deadline_ns = deadline_ns;
+        worker->search.expired = false;
+        worker->search.out_of_memory = false;
+    }
+}
+
+// Add the counters of a worker to the stats of the solve, the arena bytes are the bytes the solve allocated in the
+// worker arenas
+static void AddSearchStats(struct SearchStats_s* stats, const struct AStarWorker_s* worker)
+{
+    stats->nb_nodes += worker->search.stats.nb_nodes;
+#ifdef RUMMIKUB_STATS
+    for(int kind = 0; kind < NB_MOVE_KINDS; kind++)
+        stats->successors[kind] += worker->search.stats.successors[kind];
+    stats->duplicates += worker->search.stats.duplicates;
+    stats->reopened += worker->search.stats.reopened;
+    stats->pruned += worker->search.stats.pruned;
+    STATS_MAX(stats, peak_frontier, worker->search.stats.peak_frontier);
+    stats->arena_bytes += worker->moves_arena.allocated + worker->search.arena.allocated;
+    for(int timer = 0; timer < NB_STATS_TIMERS; timer++)
+        stats->cycles[timer] += worker->search.stats.cycles[timer];
+#endif
+}
+
+// Add a table reached by a placement to its steps, the steps past MAX_PLACEMENT_STEPS are only counted
+static void AddPlacementStep(struct Placement_s* placement, const struct TableState_s* table_state, struct TileBitboard_s placed_tiles)
+{
+    if(placement->nb_steps < MAX_PLACEMENT_STEPS)
+    {
+        struct PlacementStep_s* step = &placement->steps[placement->nb_steps];
+        step->placed_tiles = placed_tiles;
+        step->nb_sets = 0;
+        for(int i = 0; i < table_state->nb_sets; i++)
+        {
+            if(table_state->sets[i].one | table_state->sets[i].two)
+                step->sets[step->nb_sets++] = table_state->sets[i];
+        }
+    }
+    placement->nb_steps++;
+}
+
+// Place the rack tiles one at a time on the table, each time keeping the best resolved table,
+// the placement is the last table reached and each table reached is a step.
+// Return false when the memory of the search runs out.
+// The sub-searches of a layer run on the threads of the pool and are merged in candidate order so the
+// result does not depend on the number of threads
+bool SolveAStar(const struct TableState_s* table_state, struct TileBitboard_s player_tiles, struct Placement_s* placement, const struct SolverOptions_s* options, struct AStarPool_s* warm_pool)
+{
+    struct TileBitboard_s table_tiles = GetTableStateTiles(table_state);
+    // Without a warm pool the solve starts its own pool
+    struct AStarPool_s* pool = warm_pool;
+    if(!pool)
+    {
+        pool = malloc(sizeof(struct AStarPool_s));
+        if(!pool)
+            return false;
+        if(!InitAStarPool(pool, options))
+        {
+            free(pool);
+            return false;
+        }
+    }
+    // Every worker reads the clock for itself, the layer running when the deadline passes keeps the tables it resolved
+    ResetAStarPool(pool, options->deadline_ms > 0 ? GetMonotonicNanoseconds() + (uint64_t)(options->deadline_ms * 1e6) : 0);
+
+    // The start table is in the moves arena, the resolved tables in the moves arenas of the workers
+    struct Arena_s moves_arena;
+    InitArena(&moves_arena);
+    struct PriorityQueue_s* start_queue = CreatePriorityQueue(&moves_arena, table_state, NULL, 0);
+    struct PriorityQueue_s* current_queue = start_queue;
+    bool out_of_memory = !start_queue;
+    struct PriorityQueueHeap_s next_queue;
+    InitPriorityQueue(&next_queue);
+    struct AStarCandidate_s candidates[(MAX_TABLE_SETS + 1) * NB_COLORS * NB_NUMBERS];
+    struct AStarResult_s results[(MAX_TABLE_SETS + 1) * NB_COLORS * NB_NUMBERS];
+    struct TableState_s current_state;
+
+    placement->table_state = *table_state;
+    placement->timed_out = false;
+    placement->nb_steps = 0;
+    struct TileBitboard_s previous_tiles = table_tiles;
+    while(current_queue)
+    {
+        GetPriorityQueueTableState(current_queue, &current_state);
+        placement->table_state = current_state;
+        struct TileBitboard_s current_tiles = GetTableStateTiles(&current_state);
+        if(current_queue != start_queue)
+            AddPlacementStep(placement, &current_state, BitboardDifference(current_tiles, previous_tiles));
+        previous_tiles = current_tiles;
+        if(placement->timed_out)
+            break;
+        // Tiles of the rack that are not already placed on this table
+        struct TileBitboard_s placed_tiles = BitboardDifference(current_tiles, table_tiles);
+        struct TileBitboard_s rack_tiles = BitboardDifference(player_tiles, placed_tiles);
+        // Try every rack tile in every table set, the last index puts the tile in a new set
+        int nb_candidates = 0;
+        for(int i = 0; i <= current_state.nb_sets; i++)
+        {
+            uint64_t player_tiles_left = rack_tiles.one;
+            while(player_tiles_left)
+            {
+                int bit = __builtin_ctzll(player_tiles_left);
+                player_tiles_left &= player_tiles_left - 1;
+                candidates[nb_candidates++] = (struct AStarCandidate_s){i, bit};
+            }
+        }
+        RunAStarLayer(pool, &current_state, candidates, results, nb_candidates);
+        for(int i = 0; i < pool->nb_workers; i++)
+        {
+            placement->timed_out |= pool->workers[i].search.expired;
+            out_of_memory |= pool->workers[i].search.out_of_memory;
+        }
+
+        for(int i = 0; i < nb_candidates && !out_of_memory; i++)
+        {
+            if(results[i].state)
+                out_of_memory = !AddToPriorityQueue(&next_queue, results[i].state);
+        }
+        if(out_of_memory)
+            break;
+        // Keep playing from the best resolved table
+        current_queue = PopFromPriorityQueue(&next_queue);
+        EmptyPriorityQueue(&next_queue);
+    }
+
+    ClearPriorityQueue(&next_queue);
+    placement->stats = (struct SearchStats_s){0};
+    for(int i = 0; i < pool->nb_workers; i++)
+        AddSearchStats(&placement->stats, &pool->workers[i]);
+    STATS_ADD(&placement->stats, arena_bytes, moves_arena.allocated);
+    FreeArena(&moves_arena);
+    if(!warm_pool)
+    {
+        FreeAStarPool(pool);
+        free(pool);
+    }
+    if(out_of_memory)
+        return false;
+
+    RemoveEmptySetsFromTableState(&placement->table_state);
+    placement->placed_tiles = BitboardDifference(GetTableStateTiles(&placement->table_state), table_tiles);
+    placement->nb_placed_tiles = GetBitboardTilesNumber(placement->placed_tiles);
+    placement->score = GetBitboardScore(placement->placed_tiles);
+    return true;
+}
+
+// Unordered pairs of run lengths (0 to 3) of the two copies of a color, in pair index order
+static const uint8_t dp_pair_lengths[DP_RUN_STATES][2] = {
+    {0, 0}, {0, 1}, {0, 2}, {0, 3}, {1, 1}, {1, 2}, {1, 3}, {2, 2}, {2, 3}, {3, 3}
+};
+static const uint8_t dp_pair_index[4][4] = {
+    {0, 1, 2, 3}, {1, 4, 5, 6}, {2, 5, 7, 8}, {3, 6, 8, 9}
+};
+static const int dp_color_weights[NB_COLORS] = {1, DP_RUN_STATES, DP_RUN_STATES * DP_RUN_STATES, DP_RUN_STATES * DP_RUN_STATES * DP_RUN_STATES};
+
+// Choice for the tiles of one color at one number
+struct DPColorOption_s{
+    uint8_t run_state;      // Pair index of the run lengths after the number
+    uint8_t group_tiles;    // Tiles of the color put in groups
+    uint8_t placed_tiles;   // Rack tiles used
+    uint8_t takes;          // Bit i is set when the run of the copy i takes a tile
+};
+
+// Exact solver sweeping the numbers from 1 to 13 with the run lengths of each color as state
+struct DPSolver_s{
+    uint8_t table_counts[NB_NUMBERS][NB_COLORS];
+    uint8_t rack_counts[NB_NUMBERS][NB_COLORS];
+    enum SolverObjective_e objective;
+    unsigned long nb_nodes;     // States solved
+    int16_t memo[NB_NUMBERS][DP_STATES];
+};
+
+static int Min(int a, int b)
+{
+    return a < b ? a : b;
+}
+
+// Store the choices for a color whose two runs have length a and b, return their number
+static int GetDPColorOptions(int a, int b, int table_count, int rack_count, struct DPColorOption_s* options)
+{
+    int nb_options = 0;
+    for(int takes = 0; takes < 4; takes++)
+    {
+        int take_a = takes & 1;
+        int take_b = takes >> 1;
+        // A run of 1 or 2 tiles must continue
+        if((!take_a && (a == 1 || a == 2)) || (!take_b && (b == 1 || b == 2)))
+            continue;
+        // Both runs are the same, continuing one or the other gives the same state
+        if(a == b && takes == 2)
+            continue;
+        int new_a = take_a ? Min(a + 1, 3) : 0;
+        int new_b = take_b ? Min(b + 1, 3) : 0;
+        // Every table tile is used, rack tiles are optional
+        for(int used = table_count; used <= table_count + rack_count && used <= 2; used++)
+        {
+            int group_tiles = used - take_a - take_b;
+            if(group_tiles < 0)
+                continue;
+            options[nb_options++] = (struct DPColorOption_s){dp_pair_index[new_a][new_b], group_tiles, used - table_count, takes};
+        }
+    }
+    return nb_options;
+}
+
+// The tiles put in groups at one number must make one group of 3 or 4 colors or two groups
+static bool AreDPGroupsValid(const int* group_tiles)
+{
+    int nb_tiles = group_tiles[0] + group_tiles[1] + group_tiles[2] + group_tiles[3];
+    if(nb_tiles == 0 || nb_tiles >= 6)
+        return true;
+    if(nb_tiles < 3 || nb_tiles > 4)
+        return false;
+    return group_tiles[0] < 2 && group_tiles[1] < 2 && group_tiles[2] < 2 && group_tiles[3] < 2;
+}
+
+static int GetDPPlacedValue(const struct DPSolver_s* solver, int number_index, int placed_tiles)
+{
+    if(solver->objective == OBJECTIVE_SCORE)
+        return placed_tiles * (number_index + 1);
+    return placed_tiles;
+}
+
+// Store the options of every color at a number for the given state, the runs of a color are the two copies lengths
+static void GetDPOptions(const struct DPSolver_s* solver, int number_index, const uint8_t run_lengths[NB_COLORS][2], struct DPColorOption_s options[NB_COLORS][12], int* nb_options)
+{
+    for(int color = 0; color < NB_COLORS; color++)
+        nb_options[color] = GetDPColorOptions(run_lengths[color][0], run_lengths[color][1], solver->table_counts[number_index][color], solver->rack_counts[number_index][color], options[color]);
+}
+
+static void GetDPRunLengths(int state, uint8_t run_lengths[NB_COLORS][2])
+{
+    for(int color = 0; color < NB_COLORS; color++)
+    {
+        int pair = state % DP_RUN_STATES;
+        run_lengths[color][0] = dp_pair_lengths[pair][0];
+        run_lengths[color][1] = dp_pair_lengths[pair][1];
+        state /= DP_RUN_STATES;
+    }
+}
+
+// Best value placed from the number to 13 when the runs entering the number are the given state
+static int16_t SolveDPNumber(struct DPSolver_s* solver, int number_index, int state)
+{
+    if(number_index == NB_NUMBERS)
+    {
+        // Every run must be closed with at least 3 tiles
+        uint8_t run_lengths[NB_COLORS][2];
+        GetDPRunLengths(state, run_lengths);
+        for(int color = 0; color < NB_COLORS; color++)
+        {
+            if((run_lengths[color][0] % 3) || (run_lengths[color][1] % 3))
+                return DP_INFEASIBLE;
+        }
+        return 0;
+    }
+    if(solver->memo[number_index][state] != DP_UNKNOWN)
+        return solver->memo[number_index][state];
+    solver->nb_nodes++;
+
+    uint8_t run_lengths[NB_COLORS][2];
+    struct DPColorOption_s options[NB_COLORS][12];
+    int nb_options[NB_COLORS];
+    GetDPRunLengths(state, run_lengths);
+    GetDPOptions(solver, number_index, run_lengths, options, nb_options);
+
+    int best = DP_INFEASIBLE;
+    int group_tiles[NB_COLORS];
+    for(int i0 = 0; i0 < nb_options[0]; i0++)
+    {
+        const struct DPColorOption_s* o0 = &options[0][i0];
+        group_tiles[0] = o0->group_tiles;
+        for(int i1 = 0; i1 < nb_options[1]; i1++)
+        {
+            const struct DPColorOption_s* o1 = &options[1][i1];
+            group_tiles[1] = o1->group_tiles;
+            for(int i2 = 0; i2 < nb_options[2]; i2++)
+            {
+                const struct DPColorOption_s* o2 = &options[2][i2];
+                group_tiles[2] = o2->group_tiles;
+                for(int i3 = 0; i3 < nb_options[3]; i3++)
+                {
+                    const struct DPColorOption_s* o3 = &options[3][i3];
+                    group_tiles[3] = o3->group_tiles;
+                    if(!AreDPGroupsValid(group_tiles))
+                        continue;
+                    int next_state = o0->run_state * dp_color_weights[0] + o1->run_state * dp_color_weights[1]
+                                   + o2->run_state * dp_color_weights[2] + o3->run_state * dp_color_weights[3];
+                    int next_value = SolveDPNumber(solver, number_index + 1, next_state);
+                    if(next_value == DP_INFEASIBLE)
+                        continue;
+                    int value = next_value + GetDPPlacedValue(solver, number_index, o0->placed_tiles + o1->placed_tiles + o2->placed_tiles + o3->placed_tiles);
+                    if(value > best)
+                        best = value;
+                }
+            }
+        }
+    }
+    solver->memo[number_index][state] = best;
+    return best;
+}
+
+// Add the groups made at a number to the table, with two groups the colors with two tiles are in both
+// and the colors with one tile are shared between them
+static bool AddDPGroups(struct TableState_s* table_state, int number_index, const int* group_tiles)
+{
+    struct TileBitboard_s groups[2] = {{0, 0}, {0, 0}};
+    bool two_groups = group_tiles[0] + group_tiles[1] + group_tiles[2] + group_tiles[3] > 4;
+    int next_group = 0;
+    for(int color = 0; color < NB_COLORS; color++)
+    {
+        uint64_t tile = 1ULL << (color * COLOR_LANE_BITS + number_index);
+        if(group_tiles[color] == 2)
+        {
+            groups[0].one |= tile;
+            groups[1].one |= tile;
+        }
+        else if(group_tiles[color] == 1)
+        {
+            groups[next_group].one |= tile;
+            if(two_groups)
+                next_group ^= 1;
+        }
+    }
+    for(int i = 0; i < 2; i++)
+    {
+        if(groups[i].one && !AddSetToTableState(table_state, groups[i]))
+            return false;
+    }
+    return true;
+}
+
+// Follow the best choices from number 1 to 13 and build the runs and groups of the table
+static bool BuildDPPlacement(struct DPSolver_s* solver, struct Placement_s* placement)
+{
+    // Length (capped at 3) and first number of the run of each copy of each color
+    uint8_t run_lengths[NB_COLORS][2] = {{0}};
+    int run_starts[NB_COLORS][2] = {{0}};
+    int state = 0;
+    InitTableState(&placement->table_state);
+    placement->placed_tiles = (struct TileBitboard_s){0, 0};
+
+    for(int number_index = 0; number_index < NB_NUMBERS; number_index++)
+    {
+        int target = SolveDPNumber(solver, number_index, state);
+        struct DPColorOption_s options[NB_COLORS][12];
+        int nb_options[NB_COLORS];
+        GetDPOptions(solver, number_index, run_lengths, options, nb_options);
+
+        int choice[NB_COLORS];
+        int group_tiles[NB_COLORS];
+        int next_state = -1;
+        for(int i = 0; i < nb_options[0] * nb_options[1] * nb_options[2] * nb_options[3] && next_state < 0; i++)
+        {
+            int rest = i;
+            int placed_tiles = 0;
+            int candidate_state = 0;
+            for(int color = NB_COLORS - 1; color >= 0; color--)
+            {
+                choice[color] = rest % nb_options[color];
+                rest /= nb_options[color];
+            }
+            for(int color = 0; color < NB_COLORS; color++)
+            {
+                const struct DPColorOption_s* option = &options[color][choice[color]];
+                group_tiles[color] = option->group_tiles;
+                placed_tiles += option->placed_tiles;
+                candidate_state += option->run_state * dp_color_weights[color];
+            }
+            if(!AreDPGroupsValid(group_tiles))
+                continue;
+            int next_value = SolveDPNumber(solver, number_index + 1, candidate_state);
+            if(next_value != DP_INFEASIBLE && next_value + GetDPPlacedValue(solver, number_index, placed_tiles) == target)
+                next_state = candidate_state;
+        }
+        if(next_state < 0)
+            return false;
+
+        for(int color = 0; color < NB_COLORS; color++)
+        {
+            const struct DPColorOption_s* option = &options[color][choice[color]];
+            int bit = color * COLOR_LANE_BITS + number_index;
+            for(int copy = 0; copy < 2; copy++)
+            {
+                if(option->takes & (1 << copy))
+                {
+                    if(!run_lengths[color][copy])
+                        run_starts[color][copy] = number_index;
+                    run_lengths[color][copy] = Min(run_lengths[color][copy] + 1, 3);
+                    continue;
+                }
+                // The run stops before this number
+                if(run_lengths[color][copy])
+                {
+                    uint64_t run = ((1ULL << (number_index - run_starts[color][copy])) - 1) << (color * COLOR_LANE_BITS + run_starts[color][copy]);
+                    if(!AddSetToTableState(&placement->table_state, (struct TileBitboard_s){run, 0}))
+                        return false;
+                }
+                run_lengths[color][copy] = 0;
+            }
+            for(int placed = 0; placed < option->placed_tiles; placed++)
+                AddBitToBitboard(&placement->placed_tiles, bit);
+        }
+        if(!AddDPGroups(&placement->table_state, number_index, group_tiles))
+            return false;
+        state = next_state;
+    }
+    // Close the runs going up to 13
+    for(int color = 0; color < NB_COLORS; color++)
+    {
+        for(int copy = 0; copy < 2; copy++)
+        {
+            if(!run_lengths[color][copy])
+                continue;
+            uint64_t run = ((1ULL << (NB_NUMBERS - run_starts[color][copy])) - 1) << (color * COLOR_LANE_BITS + run_starts[color][copy]);
+            if(!AddSetToTableState(&placement->table_state, (struct TileBitboard_s){run, 0}))
+                return false;
+        }
+    }
+    placement->nb_placed_tiles = GetBitboardTilesNumber(placement->placed_tiles);
+    placement->score = GetBitboardScore(placement->placed_tiles);
+    return true;
+}
+
+// Rearrange the table tiles with the rack tiles placing the most tiles or the highest score,
+// return false if the table tiles cannot be arranged in valid sets
+bool SolveDP(struct TileBitboard_s table_tiles, struct TileBitboard_s rack_tiles, enum SolverObjective_e objective, struct Placement_s* placement)
+{
+    struct DPSolver_s* solver = malloc(sizeof(struct DPSolver_s));
+    if(!solver)
+        return false;
+    solver->objective = objective;
+    solver->nb_nodes = 0;
+    for(int number_index = 0; number_index < NB_NUMBERS; number_index++)
+    {
+        for(int color = 0; color < NB_COLORS; color++)
+        {
+            int bit = color * COLOR_LANE_BITS + number_index;
+            int table_count = GetBitboardTileCount(table_tiles, bit);
+            solver->table_counts[number_index][color] = table_count;
+            solver->rack_counts[number_index][color] = Min(GetBitboardTileCount(rack_tiles, bit), 2 - table_count);
+        }
+        for(int state = 0; state < DP_STATES; state++)
+            solver->memo[number_index][state] = DP_UNKNOWN;
+    }
+    bool solved = SolveDPNumber(solver, 0, 0) != DP_INFEASIBLE && BuildDPPlacement(solver, placement);
+    placement->stats = (struct SearchStats_s){.nb_nodes = solver->nb_nodes};
+    STATS_ADD(&placement->stats, arena_bytes, sizeof(struct DPSolver_s));
+    placement->timed_out = false;
+    free(solver);
+    return solved;
+}
+
+// Fill the run scores of the configurations that start with the given counts of the lower numbers. best holds the
+// highest score of the tiles put in runs so far for each pair of run lengths, or -1 when the pair is not reachable
+static void FillRunScores(uint8_t* scores, int number_index, int config, int power, const int16_t best[DP_RUN_STATES])
+{
+    if(number_index == NB_NUMBERS)
+    {
+        // Every run must be closed with at least 3 tiles
+        int16_t score = best[dp_pair_index[0][0]];
+        if(best[dp_pair_index[0][3]] > score)
+            score = best[dp_pair_index[0][3]];
+        if(best[dp_pair_index[3][3]] > score)
+            score = best[dp_pair_index[3][3]];
+        scores[config] = score;
+        return;
+    }
+    for(int count = 0; count <= 2; count++)
+    {
+        int16_t next[DP_RUN_STATES];
+        for(int state = 0; state < DP_RUN_STATES; state++)
+            next[state] = -1;
+        for(int state = 0; state < DP_RUN_STATES; state++)
+        {
+            if(best[state] < 0)
+                continue;
+            int a = dp_pair_lengths[state][0];
+            int b = dp_pair_lengths[state][1];
+            // Each run takes a tile of the number or stops, a run of 1 or 2 tiles cannot stop
+            for(int takes = 0; takes < 4; takes++)
+            {
+                int take_a = takes & 1;
+                int take_b = takes >> 1;
+                if(take_a + take_b > count || (!take_a && a % 3) || (!take_b && b % 3))
+                    continue;
+                int next_state = dp_pair_index[take_a ? Min(a + 1, 3) : 0][take_b ? Min(b + 1, 3) : 0];
+                int16_t value = best[state] + (take_a + take_b) * (number_index + 1);
+                if(value > next[next_state])
+                    next[next_state] = value;
+            }
+        }
+        FillRunScores(scores, number_index + 1, config + count * power, power * 3, next);
+    }
+}
+
+// Compute the best run score of every color configuration
+void GenerateRunScores(uint8_t* scores)
+{
+    int16_t best[DP_RUN_STATES];
+    for(int state = 0; state < DP_RUN_STATES; state++)
+        best[state] = -1;
+    best[dp_pair_index[0][0]] = 0;
+    FillRunScores(scores, 0, 0, 1, best);
+}
+
+// Write the run table file, return false if it cannot be written
+bool WriteRunTable(const char* path)
+{
+    uint8_t* scores = malloc(NB_RUN_CONFIGS);
+    if(!scores)
+        return false;
+    GenerateRunScores(scores);
+    struct RunTableHeader_s header = {{0}, RUN_TABLE_VERSION, NB_RUN_CONFIGS};
+    memcpy(header.magic, RUN_TABLE_MAGIC, sizeof(header.magic));
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool written = fd >= 0 && write(fd, &header, sizeof(header)) == sizeof(header) && write(fd, scores, NB_RUN_CONFIGS) == NB_RUN_CONFIGS;
+    if(fd >= 0 && close(fd))
+        written = false;
+    free(scores);
+    return written;
+}
+
+// Map a run table file, return false if it cannot be mapped or was written with another layout
+bool OpenRunTable(struct RunTable_s* run_table, const char* path)
+{
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+        return false;
+    struct stat file_stat;
+    size_t map_size = sizeof(struct RunTableHeader_s) + NB_RUN_CONFIGS;
+    if(fstat(fd, &file_stat) < 0 || (size_t)file_stat.st_size != map_size)
+    {
+        close(fd);
+        return false;
+    }
+    void* map = mmap(NULL, map_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED)
+        return false;
+    const struct RunTableHeader_s* header = map;
+    if(memcmp(header->magic, RUN_TABLE_MAGIC, sizeof(header->magic)) || header->version != RUN_TABLE_VERSION || header->nb_configs != NB_RUN_CONFIGS)
+    {
+        munmap(map, map_size);
+        return false;
+    }
+    run_table->map = map;
+    run_table->map_size = map_size;
+    run_table->scores = (const uint8_t*)(header + 1);
+    for(int numbers = 0; numbers < (1 << NB_NUMBERS); numbers++)
+    {
+        uint32_t config = 0;
+        for(int number_index = NB_NUMBERS - 1; number_index >= 0; number_index--)
+            config = config * 3 + ((numbers >> number_index) & 1);
+        run_table->lane_configs[numbers] = config;
+    }
+    return true;
+}
+
+void CloseRunTable(struct RunTable_s* run_table)
+{
+    munmap(run_table->map, run_table->map_size);
+}
+
+// Upper bound of the score of the tiles that melds can hold : the run score of each color from the run table
+// plus the tiles whose number is in at least 3 colors, the only ones a group can take
+int GetRunTableBound(const struct RunTable_s* run_table, struct TileBitboard_s tiles)
+{
+    int bound = 0;
+    uint64_t lanes[NB_COLORS];
+    for(int color = 0; color < NB_COLORS; color++)
+    {
+        lanes[color] = (tiles.one >> (color * COLOR_LANE_BITS)) & COLOR_LANE_MASK;
+        uint64_t two = (tiles.two >> (color * COLOR_LANE_BITS)) & COLOR_LANE_MASK;
+        bound += run_table->scores[run_table->lane_configs[lanes[color]] + run_table->lane_configs[two]];
+    }
+    uint64_t group_numbers = (lanes[0] & lanes[1] & (lanes[2] | lanes[3])) | (lanes[2] & lanes[3] & (lanes[0] | lanes[1]));
+    struct TileBitboard_s group_tiles = {tiles.one & group_numbers * NUMBER_COLUMN, tiles.two & group_numbers * NUMBER_COLUMN};
+    bound += GetBitboardScore(group_tiles);
+    int score = GetBitboardScore(tiles);
+    return bound < score ? bound : score;
+}
+
+// Open or create the solve cache file of the given path, a new file holds at most max_bytes.
+// Return false if the file cannot be mapped or was written with another layout
+bool OpenSolveCache(struct SolveCache_s* cache, const char* path, size_t max_bytes, bool read_only)
+{
+    int fd = open(path, read_only ? O_RDONLY : O_RDWR | O_CREAT, 0644);
+    if(fd < 0)
+        return false;
+    struct stat file_stat;
+    if(fstat(fd, &file_stat) < 0)
+    {
+        close(fd);
+        return false;
+    }
+    size_t map_size = file_stat.st_size;
+    bool created = map_size == 0;
+    uint64_t nb_buckets = 1;
+    if(created)
+    {
+        if(read_only)
+        {
+            close(fd);
+            return false;
+        }
+        size_t bucket_size = SOLVE_CACHE_WAYS * sizeof(struct SolveCacheEntry_s);
+        while(sizeof(struct SolveCacheHeader_s) + 2 * nb_buckets * bucket_size <= max_bytes)
+            nb_buckets *= 2;
+        map_size = sizeof(struct SolveCacheHeader_s) + nb_buckets * bucket_size;
+        if(ftruncate(fd, map_size) < 0)
+        {
+            close(fd);
+            return false;
+        }
+    }
+    void* map = map_size < sizeof(struct SolveCacheHeader_s) ? MAP_FAILED
+              : mmap(NULL, map_size, read_only ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    // The mapping stays valid once the file is closed
+    close(fd);
+    if(map == MAP_FAILED)
+        return false;
+    cache->header = map;
+    cache->entries = (struct SolveCacheEntry_s*)(cache->header + 1);
+    cache->map_size = map_size;
+    cache->read_only = read_only;
+    if(created)
+    {
+        memcpy(cache->header->magic, SOLVE_CACHE_MAGIC, sizeof(cache->header->magic));
+        cache->header->version = SOLVE_CACHE_VERSION;
+        cache->header->entry_size = sizeof(struct SolveCacheEntry_s);
+        cache->header->nb_buckets = nb_buckets;
+        cache->header->clock = 0;
+    }
+    const struct SolveCacheHeader_s* header = cache->header;
+    if(memcmp(header->magic, SOLVE_CACHE_MAGIC, sizeof(header->magic)) || header->version != SOLVE_CACHE_VERSION
+       || header->entry_size != sizeof(struct SolveCacheEntry_s) || !header->nb_buckets || (header->nb_buckets & (header->nb_buckets - 1))
+       || sizeof(struct SolveCacheHeader_s) + header->nb_buckets * SOLVE_CACHE_WAYS * sizeof(struct SolveCacheEntry_s) > map_size)
+    {
+        munmap(map, map_size);
+        return false;
+    }
+    return true;
+}
+
+void CloseSolveCache(struct SolveCache_s* cache)
+{
+    munmap(cache->header, cache->map_size);
+}
+
+// Identifier of the engine and search settings, the cache only returns results found with the same settings
+static uint32_t GetSolveCacheSolver(const struct SolverOptions_s* options)
+{
+    if(options->engine == ENGINE_DP)
+        return ENGINE_DP | options->objective << 4;
+    return ENGINE_ASTAR | options->iterative_deepening << 4 | options->max_depth << 8 | (GetHeuristicIndex(options->heuristic) + 1) << 16;
+}
+
+// Hash of a game state with the colors permuted
+static uint64_t GetGameStateHash(struct TileBitboard_s rack_tiles, const struct TableState_s* table_state, int permutation, uint32_t solver)
+{
+    uint64_t hash = 0;
+    for(int i = 0; i < table_state->nb_sets; i++)
+        hash += GetSetHashContribution(PermuteBitboardColors(table_state->sets[i], permutation));
+    struct TileBitboard_s rack = PermuteBitboardColors(rack_tiles, permutation);
+    return SplitMix64(hash ^ SplitMix64(rack.one ^ SplitMix64(rack.two ^ solver)));
+}
+
+// Canonical key of a game state : the smallest hash of the game state over the color permutations, stored with
+// the permutation reaching it. Game states equal up to the colors have the same key
+static uint64_t GetCanonicalGameStateKey(struct TileBitboard_s rack_tiles, const struct TableState_s* table_state, uint32_t solver, int* permutation)
+{
+    uint64_t min_key = UINT64_MAX;
+    for(int i = 0; i < NB_COLOR_PERMUTATIONS; i++)
+    {
+        uint64_t key = GetGameStateHash(rack_tiles, table_state, i, solver);
+        if(key < min_key)
+        {
+            min_key = key;
+            *permutation = i;
+        }
+    }
+    // 0 marks the empty entries
+    return min_key ? min_key : 1;
+}
+
+// Return the permutation taking back the colors permuted by the given one
+static int GetInverseColorPermutation(int permutation)
+{
+    for(int inverse = 0; inverse < NB_COLOR_PERMUTATIONS; inverse++)
+    {
+        bool is_inverse = true;
+        for(int color = 0; color < NB_COLORS; color++)
+            is_inverse &= color_permutations[inverse][color_permutations[permutation][color]] == color;
+        if(is_inverse)
+            return inverse;
+    }
+    return 0;
+}
+
+// Look a game state up in the cache and rebuild its placement, return false if it is not in the cache
+bool LookupSolveCache(struct SolveCache_s* cache, const struct SolverOptions_s* options, struct TileBitboard_s rack_tiles, const struct TableState_s* table_state, struct Placement_s* placement)
+{
+    uint32_t solver = GetSolveCacheSolver(options);
+    int permutation;
+    uint64_t key = GetCanonicalGameStateKey(rack_tiles, table_state, solver, &permutation);
+    struct TileBitboard_s table_tiles = GetTableStateTiles(table_state);
+    struct TileBitboard_s canonical_rack = PermuteBitboardColors(rack_tiles, permutation);
+    struct TileBitboard_s canonical_table = PermuteBitboardColors(table_tiles, permutation);
+    struct SolveCacheEntry_s* bucket = &cache->entries[(key & (cache->header->nb_buckets - 1)) * SOLVE_CACHE_WAYS];
+    for(int way = 0; way < SOLVE_CACHE_WAYS; way++)
+    {
+        struct SolveCacheEntry_s* entry = &bucket[way];
+        if(__atomic_load_n(&entry->key, __ATOMIC_ACQUIRE) != key)
+            continue;
+        struct SolveCacheEntry_s result = *entry;
+        // The entry may have been replaced by a writer while it was copied, the copy is done before the key is read again
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if(__atomic_load_n(&entry->key, __ATOMIC_RELAXED) != key || result.solver != solver || result.nb_melds > MAX_TABLE_SETS
+           || result.rack_tiles.one != canonical_rack.one || result.rack_tiles.two != canonical_rack.two
+           || result.table_tiles.one != canonical_table.one || result.table_tiles.two != canonical_table.two)
+            continue;
+        int inverse = GetInverseColorPermutation(permutation);
+        InitTableState(&placement->table_state);
+        bool valid = true;
+        for(uint32_t i = 0; i < result.nb_melds; i++)
+            valid &= AddSetToTableState(&placement->table_state, PermuteBitboardColors((struct TileBitboard_s){result.melds[i], 0}, inverse));
+        struct TileBitboard_s tiles = GetTableStateTiles(&placement->table_state);
+        placement->placed_tiles = BitboardDifference(tiles, table_tiles);
+        // A torn or damaged entry is not used : its melds must be valid and hold the table tiles and rack tiles only
+        if(!valid || !AreValidTableSets(&placement->table_state) || !IsBitboardSubsetOf(table_tiles, tiles)
+           || !IsBitboardSubsetOf(placement->placed_tiles, rack_tiles))
+            continue;
+        placement->nb_placed_tiles = GetBitboardTilesNumber(placement->placed_tiles);
+        placement->score = GetBitboardScore(placement->placed_tiles);
+        placement->stats = (struct SearchStats_s){0};
+        placement->timed_out = false;
+        if(!cache->read_only)
+            entry->last_used = ++cache->header->clock;
+        return true;
+    }
+    return false;
+}
+
+// Store the placement of a game state in the cache, replacing the least recently used entry of its bucket
+void StoreSolveCache(struct SolveCache_s* cache, const struct SolverOptions_s* options, struct TileBitboard_s rack_tiles, const struct TableState_s* table_state, const struct Placement_s* placement)
+{
+    if(cache->read_only)
+        return;
+    struct SolveCacheEntry_s result = {0};
+    for(int i = 0; i < placement->table_state.nb_sets; i++)
+    {
+        struct TileBitboard_s set = placement->table_state.sets[i];
+        // Only valid melds can be stored in one word
+        if(set.two)
+            return;
+        if(set.one)
+            result.melds[result.nb_melds++] = set.one;
+    }
+    int permutation;
+    result.solver = GetSolveCacheSolver(options);
+    uint64_t key = GetCanonicalGameStateKey(rack_tiles, table_state, result.solver, &permutation);
+    result.rack_tiles = PermuteBitboardColors(rack_tiles, permutation);
+    result.table_tiles = PermuteBitboardColors(GetTableStateTiles(table_state), permutation);
+    for(uint32_t i = 0; i < result.nb_melds; i++)
+        result.melds[i] = PermuteColorLanes(result.melds[i], permutation);
+    result.last_used = ++cache->header->clock;
+
+    struct SolveCacheEntry_s* bucket = &cache->entries[(key & (cache->header->nb_buckets - 1)) * SOLVE_CACHE_WAYS];
+    struct SolveCacheEntry_s* replaced = &bucket[0];
+    for(int way = 0; way < SOLVE_CACHE_WAYS; way++)
+    {
+        struct SolveCacheEntry_s* entry = &bucket[way];
+        if(!entry->key || entry->key == key)
+        {
+            replaced = entry;
+            break;
+        }
+        if(result.last_used - entry->last_used > result.last_used - replaced->last_used)
+            replaced = entry;
+    }
+    // The key is cleared before any field of the entry is written and set once they are all written
+    __atomic_store_n(&replaced->key, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    size_t content_offset = offsetof(struct SolveCacheEntry_s, rack_tiles);
+    memcpy((char*)replaced + content_offset, (const char*)&result + content_offset, sizeof(result) - content_offset);
+    __atomic_store_n(&replaced->key, key, __ATOMIC_RELEASE);
+}
+
+// Solver handle. The tables are only read by the solves, the cache and the warm pool are taken by one solve at a time
+struct Rummikub_s{
+    struct SolverOptions_s options;
+    struct MeldTable_s meld_table;
+    struct RunTable_s run_table;
+    bool has_run_table;
+    struct SolveCache_s cache;
+    bool has_cache;
+    pthread_mutex_t cache_lock;     // Held by the lookups and stores of the cache
+    struct AStarPool_s* pool;       // A* threads kept between the solves, NULL for the exact engine
+    pthread_mutex_t pool_lock;      // Held by the solve running on the pool, the other solves start their own pool
+};
+
+struct Rummikub_s* CreateRummikub(const struct SolverOptions_s* options, const char** error)
+{
+    struct Rummikub_s* solver = malloc(sizeof(struct Rummikub_s));
+    if(!solver)
+    {
+        *error = "allocation failed";
+        return NULL;
+    }
+    solver->options = *options;
+    InitMeldTable(&solver->meld_table);
+    solver->has_run_table = options->run_table_path && OpenRunTable(&solver->run_table, options->run_table_path);
+    if(options->run_table_path && !solver->has_run_table)
+    {
+        *error = "cannot open the run table";
+        free(solver);
+        return NULL;
+    }
+    solver->has_cache = options->cache_path && OpenSolveCache(&solver->cache, options->cache_path, options->cache_bytes, options->cache_read_only);
+    if(options->cache_path && !solver->has_cache)
+    {
+        *error = "cannot open the cache";
+        if(solver->has_run_table)
+            CloseRunTable(&solver->run_table);
+        free(solver);
+        return NULL;
+    }
+    pthread_mutex_init(&solver->cache_lock, NULL);
+    pthread_mutex_init(&solver->pool_lock, NULL);
+    // The A* threads are started once for all the solves, without them each solve starts its own
+    solver->pool = NULL;
+    if(options->engine == ENGINE_ASTAR && (solver->pool = malloc(sizeof(struct AStarPool_s))) && !InitAStarPool(solver->pool, options))
+    {
+        free(solver->pool);
+        solver->pool = NULL;
+    }
+    return solver;
+}
+
+void FreeRummikub(struct Rummikub_s* solver)
+{
+    if(!solver)
+        return;
+    if(solver->pool)
+    {
+        FreeAStarPool(solver->pool);
+        free(solver->pool);
+    }
+    if(solver->has_cache)
+        CloseSolveCache(&solver->cache);
+    if(solver->has_run_table)
+        CloseRunTable(&solver->run_table);
+    pthread_mutex_destroy(&solver->pool_lock);
+    pthread_mutex_destroy(&solver->cache_lock);
+    free(solver);
+}
+
+const struct SolverOptions_s* GetRummikubOptions(const struct Rummikub_s* solver)
+{
+    return &solver->options;
+}
+
+const char* SolveRummikub(struct Rummikub_s* solver, struct TileBitboard_s rack_tiles, const struct TableState_s* table_state, struct Placement_s* placement)
+{
+    const struct SolverOptions_s* options = &solver->options;
+    if(solver->has_cache)
+    {
+        pthread_mutex_lock(&solver->cache_lock);
+        bool found = LookupSolveCache(&solver->cache, options, rack_tiles, table_state, placement);
+        pthread_mutex_unlock(&solver->cache_lock);
+        if(found)
+        {
+            placement->nb_steps = 0;
+            if(placement->nb_placed_tiles)
+                AddPlacementStep(placement, &placement->table_state, placement->placed_tiles);
+            return NULL;
+        }
+    }
+    if(options->engine == ENGINE_DP)
+    {
+        if(!SolveDP(GetTableStateTiles(table_state), rack_tiles, options->objective, placement))
+            return "no solution";
+        placement->nb_steps = 0;
+        if(placement->nb_placed_tiles)
+            AddPlacementStep(placement, &placement->table_state, placement->placed_tiles);
+    }
+    else
+    {
+        bool solved;
+        if(solver->pool && !pthread_mutex_trylock(&solver->pool_lock))
+        {
+            solved = SolveAStar(table_state, rack_tiles, placement, options, solver->pool);
+            pthread_mutex_unlock(&solver->pool_lock);
+        }
+        else
+            solved = SolveAStar(table_state, rack_tiles, placement, options, NULL);
+        if(!solved)
+            return "allocation failed";
+    }
+    // A placement cut by the deadline may not be the one a full solve finds
+    if(solver->has_cache && !placement->timed_out)
+    {
+        pthread_mutex_lock(&solver->cache_lock);
+        StoreSolveCache(&solver->cache, options, rack_tiles, table_state, placement);
+        pthread_mutex_unlock(&solver->cache_lock);
+    }
+    return NULL;
+}
+
+int SolveRummikubRack(const struct Rummikub_s* solver, struct TileBitboard_s tiles, struct TableState_s* best_sets, unsigned long* nb_nodes)
+{
+    return SolveCombinations(&solver->meld_table, tiles, best_sets, nb_nodes, solver->has_run_table ? &solver->run_table : NULL);
+}
+
+int GetRummikubMelds(const struct Rummikub_s* solver, struct TileBitboard_s tiles, struct TileBitboard_s* melds)
+{
+    uint16_t meld_indexes[NB_MELDS];
+    int nb_meld_indexes = GetMeldsFromTiles(&solver->meld_table, tiles, meld_indexes);
+    for(int i = 0; i < nb_meld_indexes; i++)
+        melds[i] = (struct TileBitboard_s){solver->meld_table.melds[meld_indexes[i]].tiles, 0};
+    return nb_meld_indexes;
+}
+
+
+
+// Allocate size bytes aligned on 16 bytes in the arena, return NULL if the system is out of memory
+void* ArenaAlloc(struct Arena_s* arena, size_t size)
+{
+    size = (size + 15) & ~(size_t)15;
+    while(!arena->block || arena->used + size > arena->block->size)
+    {
+        // Fill the blocks kept by the last reset before allocating a new one
+        if(arena->block && arena->block->next_block)
+        {
+            arena->block = arena->block->next_block;
+            arena->used = 0;
+            continue;
+        }
+        size_t block_size = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        struct ArenaBlock_s* block = malloc(sizeof(struct ArenaBlock_s) + block_size);
+        if(!block)
+            return NULL;
+        block->next_block = NULL;
+        block->size = block_size;
+        if(arena->block)
+            arena->block->next_block = block;
+        else
+            arena->first_block = block;
+        arena->block = block;
+        arena->used = 0;
+    }
+    void* memory = arena->block->data + arena->used;
+    arena->used += size;
+    arena->allocated += size;
+    return memory;
+}
+
+void InitArena(struct Arena_s* arena)
+{
+    *arena = (struct Arena_s){NULL, NULL, 0, 0};
+}
+
+// Release every allocation of the arena, the blocks are kept for the next allocations
+void ResetArena(struct Arena_s* arena)
+{
+    arena->block = arena->first_block;
+    arena->used = 0;
+}
+
+void FreeArena(struct Arena_s* arena)
+{
+    struct ArenaBlock_s* block = arena->first_block;
+    while(block)
+    {
+        struct ArenaBlock_s* next_block = block->next_block;
+        free(block);
+        block = next_block;
+    }
+    InitArena(arena);
+}
@@ -0,0 +1,232 @@
+// Rummikub solver library : finds the rack tiles a player can place on the table and the arrangement of the table
+// holding them. The library keeps no global state and writes nothing to the standard streams, everything a solve
+// reads is owned by a solver handle that several threads can use at once.
+#ifndef RUMMIKUB_H
+#define RUMMIKUB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define NB_COLORS 4
+#define NB_NUMBERS 13
+// Tiles of a game, two copies of each number of each color, and tiles of a starting rack
+#define NB_TILES (NB_COLORS * NB_NUMBERS * 2)
+#define RACK_TILES 13
+// A tile id is the bitboard bit of the tile with its copy (0 or 1) in TILE_ID_COPY, the tiles of a game have distinct
+// ids below 128
+#define TILE_ID_COPY 0x40
+#define TILE_ID_BIT_MASK 0x3F
+// Binary game state : the number of rack tiles and of table tiles, then the ids of the rack tiles and of the table
+// tiles set by set, GAME_STATE_SET_START is set on the first tile of each set
+#define GAME_STATE_SET_START 0x80
+#define GAME_STATE_HEADER_BYTES 2
+#define GAME_STATE_MAX_BYTES (GAME_STATE_HEADER_BYTES + NB_TILES)
+// Each color owns a 16 bits lane of a bitboard, the tile number n is the bit n - 1 of the lane
+#define COLOR_LANE_BITS 16
+#define ALL_TILES_MASK 0x1FFF1FFF1FFF1FFFULL
+// Maximum number of sets in a table state explored by the solver, at most 64 for the set masks of a table
+#define MAX_TABLE_SETS 48
+// Tables resolved with more moves than this are not expanded by default, a move costs at most 2
+#define MAX_RESOLVE_DEPTH 3
+// Steps of a placement kept for the caller, the A* solver places one rack tile per step
+#define MAX_PLACEMENT_STEPS 16
+// Largest depth limit accepted for a search, IDA* recursion uses one moves list per move
+#define MAX_SEARCH_DEPTH 16
+// Number of legal melds : 66 runs of 3 to 13 tiles per color and 5 groups of 3 or 4 colors per number
+#define NB_MELDS (NB_COLORS * 66 + NB_NUMBERS * 5)
+// Maximum number of threads running the A* sub-searches of a layer
+#define MAX_SOLVER_THREADS 64
+#define DEFAULT_SOLVE_CACHE_MB 64
+#define DEFAULT_RUN_TABLE_FILE "rummikub_runs.bin"
+
+// Multiset of tiles packed in two machine words, a tile is stored at bit color * 16 + number - 1
+struct TileBitboard_s{
+    uint64_t one;   // At least one copy of the tile
+    uint64_t two;   // Both copies of the tile
+};
+
+// xoshiro256** generator, each thread or game owns one and its draws only depend on its seed
+struct Random_s{
+    uint64_t state[4];
+};
+
+// Draw pile of a game, shuffled once when it is filled and drawn from its end
+struct TilePool_s{
+    uint8_t tiles[NB_TILES];    // Ids of the tiles left
+    int nb_tiles;
+};
+
+// Table state used by the solver, every set of the table is a tile bitboard.
+// The kind of each set is kept in masks of set indexes updated with the set it changes
+struct TableState_s{
+    int nb_sets;
+    uint64_t hash;          // Zobrist hash of the table, does not depend on the sets order
+    uint64_t illegal_sets;  // Sets neither empty nor valid
+    uint64_t partial_sets;  // Illegal sets that are partial sets
+    uint64_t empty_sets;
+    uint64_t changed_sets;  // Sets written since the mask was cleared, a search node only stores these sets
+    uint64_t tile_sets[NB_COLORS * COLOR_LANE_BITS];   // For each tile bit, the sets holding the tile
+    struct TileBitboard_s sets[MAX_TABLE_SETS];
+};
+
+// Solvers available to find the move of the player
+enum SolverEngine_e{
+    ENGINE_ASTAR,   // Rearrange the table a few moves at a time, tile by tile
+    ENGINE_DP       // Exact rearrangement of the whole table with the rack
+};
+
+// Value maximized by the exact solver
+enum SolverObjective_e{
+    OBJECTIVE_TILES,
+    OBJECTIVE_SCORE
+};
+
+// Kinds of successors generated by the A* search
+enum MoveKind_e{
+    MOVE_TO_SET,        // Tile of the illegal set moved to another set
+    MOVE_ON_START,      // Table tile added at the start of the illegal set
+    MOVE_ON_END,        // Table tile added at the end of the illegal set
+    MOVE_SPLIT,         // Illegal set of 2 tiles split in two
+    NB_MOVE_KINDS
+};
+
+// Phases of the A* search measured by the cycle timers
+enum StatsTimer_e{
+    TIMER_COPY,         // Copy of the table states of the successors and of the queued nodes
+    TIMER_HEURISTIC,    // Heuristic of the queued nodes
+    TIMER_VALIDITY,     // Valid and partial set checks
+    TIMER_INSERTION,    // Transposition table probe and heap insertion
+    NB_STATS_TIMERS
+};
+
+// Counters of a search, only the nodes are counted unless the solver is built with -DRUMMIKUB_STATS
+struct SearchStats_s{
+    unsigned long nb_nodes;     // Nodes popped from the queue
+#ifdef RUMMIKUB_STATS
+    unsigned long successors[NB_MOVE_KINDS];
+    unsigned long duplicates;   // Successors already reached with a path as short
+    unsigned long reopened;     // Queued successors reached with a shorter path
+    unsigned long pruned;       // Successors too far from a resolved table
+    int peak_frontier;
+    size_t arena_bytes;
+    uint64_t cycles[NB_STATS_TIMERS];
+#endif
+};
+
+// Table after one step of a placement, without its empty sets
+struct PlacementStep_s{
+    struct TileBitboard_s placed_tiles;     // Rack tiles put on the table by the step
+    int nb_sets;
+    struct TileBitboard_s sets[MAX_TABLE_SETS];
+};
+
+// Arrangement of the table found by a solver and the rack tiles it placed
+struct Placement_s{
+    struct TableState_s table_state;
+    struct TileBitboard_s placed_tiles;
+    int nb_placed_tiles;
+    int score;
+    struct SearchStats_s stats;     // Counters of the solve, zero when the placement comes from the cache
+    bool timed_out;             // The deadline stopped the solver, the placement is the best one found before
+    int nb_steps;               // Steps taken to reach the table, only the first MAX_PLACEMENT_STEPS are kept.
+                                // The exact solver and the cache give the table in one step
+    struct PlacementStep_s steps[MAX_PLACEMENT_STEPS];
+};
+
+// Lower bound of the number of moves left to resolve a table
+typedef float (*Heuristic_f)(const struct TableState_s* table_state);
+
+// Options of a solver handle
+struct SolverOptions_s{
+    enum SolverEngine_e engine;
+    int nb_threads;     // Threads running the A* sub-searches
+    Heuristic_f heuristic;
+    int max_depth;      // Depth limit of the sub-searches
+    bool iterative_deepening;
+    double deadline_ms;     // Time budget of an A* solve, 0 without deadline
+    const char* run_table_path;     // Run table bounding the rack melds search, NULL without run table
+    const char* cache_path;         // Solve cache file, NULL without cache
+    size_t cache_bytes;             // Size of a new cache file
+    bool cache_read_only;
+    enum SolverObjective_e objective;   // Value maximized by the exact solver
+};
+
+// Solver handle, opaque to the callers of the library
+struct Rummikub_s;
+
+// Tiles
+int GetTileBit(int number, char color);
+int GetBitNumber(int bit);
+char GetBitColor(int bit);
+bool AddBitToBitboard(struct TileBitboard_s* bitboard, int bit);
+bool AddTileToBitboard(struct TileBitboard_s* bitboard, int number, char color);
+int GetBitboardTileCount(struct TileBitboard_s bitboard, int bit);
+int GetBitboardTilesNumber(struct TileBitboard_s bitboard);
+int GetBitboardScore(struct TileBitboard_s bitboard);
+bool IsBitboardSubsetOf(struct TileBitboard_s a, struct TileBitboard_s b);
+struct TileBitboard_s BitboardUnion(struct TileBitboard_s a, struct TileBitboard_s b);
+struct TileBitboard_s BitboardDifference(struct TileBitboard_s a, struct TileBitboard_s b);
+bool IsBitboardRun(struct TileBitboard_s bitboard);
+bool IsBitboardValidSet(struct TileBitboard_s bitboard);
+
+// Tile ids
+uint8_t GetTileId(int bit, int copy);
+int GetTileIdBit(uint8_t id);
+bool IsTileId(uint8_t id);
+// Add one copy of the tile of the id, the bitboard does not keep which copy it is
+bool AddTileIdToBitboard(struct TileBitboard_s* bitboard, uint8_t id);
+// Store the ids of the tiles of a bitboard, the first copies by bit then the second copies, return their number
+int GetTileIdsFromBitboard(struct TileBitboard_s bitboard, uint8_t* ids);
+struct TileBitboard_s GetBitboardFromTileIds(const uint8_t* ids, int nb_ids);
+
+// Random draws
+void SeedRandom(struct Random_s* random, uint64_t seed);
+uint64_t GetRandom(struct Random_s* random);
+// Return a number uniformly drawn in [0, bound), bound must not be 0
+uint32_t GetRandomBelow(struct Random_s* random, uint32_t bound);
+// Fill the pile with the NB_TILES tiles in a random order
+void InitTilePool(struct TilePool_s* pool, struct Random_s* random);
+// Return the id of the next tile of the pile or -1 if the pile is empty
+int DrawTileFromPool(struct TilePool_s* pool);
+// Draw up to nb_tiles tiles of the pile in a bitboard, a rack is dealt with RACK_TILES
+struct TileBitboard_s DrawTilesFromPool(struct TilePool_s* pool, int nb_tiles);
+
+// Tables
+void InitTableState(struct TableState_s* table_state);
+bool AddSetToTableState(struct TableState_s* table_state, struct TileBitboard_s set);
+struct TileBitboard_s GetTableStateTiles(const struct TableState_s* table_state);
+bool AreValidTableSets(const struct TableState_s* table_state);
+// Write the binary game state in buffer (at most GAME_STATE_MAX_BYTES), the copies are numbered in the order of the
+// rack then of the table sets. Return its size or -1 if a tile has more than two copies
+int EncodeGameState(struct TileBitboard_s rack_tiles, const struct TableState_s* table_state, uint8_t* buffer);
+// Read a binary game state of size bytes, return the error message or NULL
+const char* DecodeGameState(const uint8_t* buffer, size_t size, struct TileBitboard_s* rack_tiles, struct TableState_s* table_state);
+
+// A* heuristics
+float heuristic(const struct TableState_s* table_state);
+float IllegalSetsHeuristic(const struct TableState_s* table_state);
+float DeficitHeuristic(const struct TableState_s* table_state);
+Heuristic_f GetHeuristicFromName(const char* name);
+const char* GetHeuristicName(Heuristic_f function);
+
+// Return the number of threads used when none is given : one per online processor
+int GetDefaultThreadCount();
+// Write the run table file, return false if it cannot be written
+bool WriteRunTable(const char* path);
+
+// Create a solver handle : the melds table, the run table and cache files of the options and the A* threads.
+// Return NULL and set the error message if the handle cannot be created
+struct Rummikub_s* CreateRummikub(const struct SolverOptions_s* options, const char** error);
+void FreeRummikub(struct Rummikub_s* solver);
+const struct SolverOptions_s* GetRummikubOptions(const struct Rummikub_s* solver);
+// Find the placement of the rack on the table with the engine of the handle, through its cache when it has one.
+// Return the error message or NULL
+const char* SolveRummikub(struct Rummikub_s* solver, struct TileBitboard_s rack_tiles, const struct TableState_s* table_state, struct Placement_s* placement);
+// Store in best_sets the melds made with the tiles alone that place the highest score and return the score,
+// the number of search nodes is stored in nb_nodes when it is not NULL
+int SolveRummikubRack(const struct Rummikub_s* solver, struct TileBitboard_s tiles, struct TableState_s* best_sets, unsigned long* nb_nodes);
+// Store the melds that can be made with the tiles, runs first, and return their number (at most NB_MELDS)
+int GetRummikubMelds(const struct Rummikub_s* solver, struct TileBitboard_s tiles, struct TileBitboard_s* melds);
+
+#endif
@@ -15,12 +15,35 @@
 // The first player to place all tiles on the table in a valid tile set wins.
 // The solver need to find the best move for the player.
 
+#include "rummikub.h"
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
-#include <stdbool.h>
 #include <string.h>
-#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <pthread.h>
+
+// Clients served at once by the solver server and longest request line
+#define MAX_SERVER_CLIENTS 64
+#define SERVER_LINE_SIZE 4096
+// Answers kept for a client not reading them before the client is dropped
+#define SERVER_OUTPUT_LIMIT (1 << 20)
+// Number of tiles or sets allocated at once by the pools
+#define POOL_CHUNK_SIZE 256
+// Seats of a simulated game and score of the first melds a player lays from the rack alone
+#define MAX_GAME_PLAYERS 4
+#define INITIAL_MELD_SCORE 30
+// Buckets of the solve latency histograms of the simulator, 4 buckets per power of 2 nanoseconds
+#define LATENCY_BUCKETS 256
 
 // Game tiles constitued of fields number (0-13) and color (R,B,G,Y)
 struct Tile_s{
@@ -42,13 +65,15 @@ struct TileSet_s{
     int number;
 };
 
-// Priority queue for A* path finding
-struct PriorityQueue_s{
-    struct TileSet_s* tile_set;
-    int g;
-    float h;
-    struct PriorityQueue_s* next_set;
-    struct PriorityQueue_s* previous_set;
+// Connection of the solver server with the start of its next request line and the answers not yet sent
+struct ServerClient_s{
+    int fd;
+    unsigned long nb_requests;
+    bool closing;
+    char* output;
+    size_t output_length;
+    size_t length;
+    char line[SERVER_LINE_SIZE];
 };
 
 // Creates a new tile with the given number and color
@@ -59,9 +84,9 @@ void PrintTile(struct Tile_s* tile);
 void PrintTileSets(struct TileSet_s* tileset);
 void PrintPlayerTileSet(struct TileSet_s* tileset);
 // Pick a random tile from the given tile set and update the tile set
-struct Tile_s* PickTileFromSet(struct TileSet_s* tileset);
+struct Tile_s* PickTileFromSet(struct TileSet_s* tileset, struct Random_s* random);
 // Return player starting tile set of 13 tiles
-struct TileSet_s* CreatePlayerTileSet(struct TileSet_s* tileset);
+struct TileSet_s* CreatePlayerTileSet(struct TileSet_s* tileset, struct Random_s* random);
 // Put a tile at the end of the given tile set and update the tile set size
 void PlaceTileInSet(struct TileSet_s* tileset, struct Tile_s* tile);
 // Split tile set in tiles sets of same color
@@ -70,76 +95,172 @@ void AddTileToSortedTileSet(struct TileSet_s** tileset, struct Tile_s* tile);
 struct TileSet_s* CreateTilesSet();
 // Solver
 bool isPartialSet(struct TileSet_s* tileset);
-
-struct TileSet_s* GetAdjacentTileSets(struct TileSet_s* tileset){
+void AddTileSetToTileSet(struct TileSet_s** tileset, struct TileSet_s* next_tileset);
+void AddTileToTileSet(struct TileSet_s** tileset, struct Tile_s* tile);
+void AddTileToTileSetQueue(struct TileSet_s* tileset, struct Tile_s* tile);
+void FreeTileSet(struct TileSet_s* tileset);
+void FreeTileSets(struct TileSet_s* tileset);
+void PrintTileNumberColor(int number, char color);
+void ReleaseTile(struct Tile_s* tile);
+void ReleaseTileSet(struct TileSet_s* tileset);
+void PrintBestMove(struct Rummikub_s* solver, const struct TileSet_s* player_tileset, const struct TileSet_s* table_tileset);
+
+struct TileBitboard_s GetBitboardFromTileSet(const struct TileSet_s* tileset)
+{
+    struct TileBitboard_s bitboard = {0, 0};
     if(!tileset)
-        return NULL;
-    struct TileSet_s* tilesets = NULL;
+        return bitboard;
+    struct Tile_s* cursor = tileset->tiles;
+    while(cursor)
+    {
+        AddTileToBitboard(&bitboard, cursor->number, cursor->color);
+        cursor = cursor->next_tile;
+    }
+    return bitboard;
+}
+
+// Union of all the tiles in a list of tile sets
+struct TileBitboard_s GetBitboardFromTileSets(const struct TileSet_s* tilesets)
+{
+    struct TileBitboard_s bitboard = {0, 0};
+    while(tilesets)
+    {
+        bitboard = BitboardUnion(bitboard, GetBitboardFromTileSet(tilesets));
+        tilesets = tilesets->next_set;
+    }
+    return bitboard;
+}
 
-    // Split the initial tile set in tiles sets of same color
-    struct TileSet_s** tilesets_by_color = SplitTileSetByColor(tileset);
-    // For each color
-    for(int i = 0; i < 4; i++){
-        // Get sequence of consecutive numbers
-        struct TileSet_s* tileset_by_color = tilesets_by_color[i];  
-        // For each tile in the set
-        struct Tile_s* cursor = tileset_by_color->tiles;
+// Add the tiles of a list of tile sets to the bitboard, return false if a tile gets more than two copies
+bool AddTileSetsToBitboard(struct TileBitboard_s* bitboard, const struct TileSet_s* tilesets)
+{
+    while(tilesets)
+    {
+        struct Tile_s* cursor = tilesets->tiles;
         while(cursor)
         {
-            int number = cursor->number;
-            struct Tile_s* tile = cursor->next_tile;
-            int sequence = 1;
-            while(tile)
-            {
-                if(tile->number == number)
-                {
-                    tile = tile->next_tile;
-                    continue;
-                }
-                if(tile->number == number + 1)
-                {
-                    sequence++;
-                    number = tile->number;
-                }
-                else
-                {
-                    if (sequence >= 3)
-                    {  
-                        struct Tile_s* start = cursor;
-                        AddTileSetToTileSet(&tilesets, CreateTilesSet());
-                        while(start != tile)
-                        {
-                            AddTileToTileSet(&tilesets, CreateTile(start->number, start->color));
-                            start = start->next_tile;
-                            number = tile->number;
-                        }
-                    }
-                    number = tile->number;
-                    cursor = tile;
-                    sequence = 1;
-                }
-                tile = tile->next_tile;
-            }
+            if(!AddTileToBitboard(bitboard, cursor->number, cursor->color))
+                return false;
+            cursor = cursor->next_tile;
+        }
+        tilesets = tilesets->next_set;
+    }
+    return true;
+}
 
-            if (sequence >= 3)
-            {  
-                struct Tile_s* start = cursor;
-                AddTileSetToTileSet(&tilesets, CreateTilesSet());
-                int i = 0;
-                while(start && (start != tile))
-                {
-                    AddTileToSortedTileSet(&tilesets, CreateTile(start->number, start->color));
-                    start = start->next_tile;                            
-                }
-            }
+// Return a tile set sorted by color then number, allocated on the heap
+struct TileSet_s* GetTileSetFromBitboard(struct TileBitboard_s bitboard)
+{
+    struct TileSet_s* tileset = CreateTilesSet();
+    uint64_t tiles = bitboard.one;
+    while(tiles)
+    {
+        int bit = __builtin_ctzll(tiles);
+        tiles &= tiles - 1;
+        for(int copy = GetBitboardTileCount(bitboard, bit); copy > 0; copy--)
+            AddTileToTileSetQueue(tileset, CreateTile(GetBitNumber(bit), GetBitColor(bit)));
+    }
+    return tileset;
+}
 
-            cursor = tile;
-        }
+// Store the ids of the tiles of a tile set, the copies are numbered in the order of the set. Return their number or
+// -1 if a tile is not a game tile or has more than two copies
+int GetTileIdsFromTileSet(const struct TileSet_s* tileset, uint8_t* ids)
+{
+    struct TileBitboard_s tiles = {0, 0};
+    int nb_ids = 0;
+    struct Tile_s* cursor = tileset ? tileset->tiles : NULL;
+    while(cursor)
+    {
+        int bit = GetTileBit(cursor->number, cursor->color);
+        if(bit < 0)
+            return -1;
+        int copy = GetBitboardTileCount(tiles, bit);
+        if(!AddBitToBitboard(&tiles, bit))
+            return -1;
+        ids[nb_ids++] = GetTileId(bit, copy);
+        cursor = cursor->next_tile;
+    }
+    return nb_ids;
+}
+
+struct TileSet_s* GetTileSetFromTileIds(const uint8_t* ids, int nb_ids)
+{
+    struct TileSet_s* tileset = CreateTilesSet();
+    for(int i = 0; i < nb_ids; i++)
+    {
+        int bit = GetTileIdBit(ids[i]);
+        AddTileToTileSetQueue(tileset, CreateTile(GetBitNumber(bit), GetBitColor(bit)));
+    }
+    return tileset;
+}
+
+void PrintBitboard(struct TileBitboard_s bitboard)
+{
+    uint64_t tiles = bitboard.one;
+    while(tiles)
+    {
+        int bit = __builtin_ctzll(tiles);
+        tiles &= tiles - 1;
+        for(int copy = GetBitboardTileCount(bitboard, bit); copy > 0; copy--)
+            PrintTileNumberColor(GetBitNumber(bit), GetBitColor(bit));
+    }
+}
+
+// Fill a table state with the non empty sets of a tile sets list, return false if there is too many sets
+bool GetTableStateFromTileSets(const struct TileSet_s* tilesets, struct TableState_s* table_state)
+{
+    InitTableState(table_state);
+    while(tilesets)
+    {
+        if(tilesets->tiles && !AddSetToTableState(table_state, GetBitboardFromTileSet(tilesets)))
+            return false;
+        tilesets = tilesets->next_set;
+    }
+    return true;
+}
 
+// Return the tile sets list of a table state, in the same order as the state sets
+struct TileSet_s* GetTileSetsFromTableState(const struct TableState_s* table_state)
+{
+    struct TileSet_s* tilesets = NULL;
+    for(int i = table_state->nb_sets - 1; i >= 0; i--)
+    {
+        struct TileSet_s* tileset = GetTileSetFromBitboard(table_state->sets[i]);
+        tileset->next_set = tilesets;
+        if(tilesets)
+            tilesets->previous_set = tileset;
+        tilesets = tileset;
     }
     return tilesets;
 }
 
+void PrintTableState(const struct TableState_s* table_state)
+{
+    for(int i = 0; i < table_state->nb_sets; i++)
+    {
+        if(!table_state->sets[i].one)
+            continue;
+        printf(" ");
+        PrintBitboard(table_state->sets[i]);
+        printf(" ");
+    }
+    printf("\n");
+}
+
+void PrintMelds(const struct TileBitboard_s* melds, int nb_melds, bool is_run)
+{
+    for(int i = 0; i < nb_melds; i++)
+    {
+        if(IsBitboardRun(melds[i]) != is_run)
+            continue;
+        printf(" ");
+        PrintBitboard(melds[i]);
+        printf(" ");
+    }
+    printf("\n");
+}
+
 // Remove tiles doublons from the given tile set
 struct TileSet_s* RemoveDoublons(struct TileSet_s* tileset){
     if((!tileset) || (tileset->tiles == NULL))
@@ -156,9 +277,9 @@ struct TileSet_s* RemoveDoublons(struct TileSet_s* tileset){
             {
                 if((tile->number == tile2->next_tile->number) && (tile->color == tile2->next_tile->color))
                 {
-                    struct tile* dup = tile2->next_tile;
+                    struct Tile_s* dup = tile2->next_tile;
                     tile2->next_tile = tile2->next_tile->next_tile;
-                    free(dup);
+                    ReleaseTile(dup);
                     cursor->number--;
                 }
                 else
@@ -173,61 +294,13 @@ struct TileSet_s* RemoveDoublons(struct TileSet_s* tileset){
     return tileset;
 }
 
-// Get all combinations of 3 tiles from adjacent tile set
-struct TileSet_s* GetAdjacentTileSetsCombinations(struct TileSet_s* tileset_colors){
-    if(!tileset_colors)
-        return NULL;
-    //struct TileSet_s* tileset = RemoveDoublons(tileset_colors);
-    struct TileSet_s* tilesets = CreateTilesSet();
-    struct TileSet_s* cursor = tileset_colors;
-    while(cursor)
-    {
-        struct Tile_s* tile = cursor->tiles;
-        struct Tile_s* start = tile;
-        
-        int i = 0;
-        int start_idx = 0;
-        int offset = 3;
-        while(offset <= cursor->number)
-        {
-            tile = cursor->tiles;
-            start_idx = 0;
-            while(tile && (start_idx+offset <= cursor->number))
-                    {
-                        AddTileToSortedTileSet(&tilesets, CreateTile(tile->number, tile->color));
-                        i++;
-                        tile = tile->next_tile;
-
-                        if(i == offset)
-                        {
-                            start = start->next_tile;
-                            tile = start;
-                            start_idx++;
-                            i = 0;
-                            AddTileSetToTileSet(&tilesets, CreateTilesSet());
-                        }
-                    }
-            offset++;
-        }
-
-        cursor = cursor->next_set;
-    }
-    if(tilesets)
-    {
-        struct TileSet_s* next = tilesets->next_set;
-        FreeTileSet(tilesets);
-        tilesets = next;
-    }
-    return tilesets;
-}
-
 void FreeTiles(struct Tile_s* tiles)
 {
     struct Tile_s* next;
     while(tiles)
     {
         next = tiles->next_tile;
-        free(tiles);
+        ReleaseTile(tiles);
         tiles = next;
     }
     
@@ -238,7 +311,7 @@ void FreeTileSet(struct TileSet_s* tileset)
     if(!tileset)
         return;
     FreeTiles(tileset->tiles);
-    free(tileset);
+    ReleaseTileSet(tileset);
 }
 
 void FreeTileSets(struct TileSet_s* tileset)
@@ -254,75 +327,6 @@ void FreeTileSets(struct TileSet_s* tileset)
 }
 
 
-// Split tiles set by number
-struct TileSet_s** SplitTileSetByNumber(struct TileSet_s* tileset){
-    struct TileSet_s** tilesets = malloc(sizeof(struct TileSet_s*)*14);
-    for(int i = 0; i < 13; i++)
-    {
-        tilesets[i] = CreateTilesSet();
-    }
-    struct Tile_s* cursor = tileset->tiles;
-    while(cursor)
-    {
-        AddTileToSortedTileSet(&tilesets[cursor->number-1], CreateTile(cursor->number, cursor->color));
-        cursor = cursor->next_tile;
-    }
-    return tilesets;
-}
-
-// Get all combinations of 3 tiles from number tile set
-struct TileSet_s* GetNumberTileSetsCombinations(struct TileSet_s** tilesets){
-    struct TileSet_s* tileset = NULL;
-    for(int i = 0; i < 13; i++)
-    {
-        struct TileSet_s* cursor = tilesets[i];
-        //cursor = RemoveDoublons(tilesets[i]);
-        if(!cursor)
-            continue;
-
-            if(cursor->number == 3)
-            {
-                //cursor = RemoveDoublons(cursor);
-                struct Tile_s* tile = cursor->tiles;
-                AddTileSetToTileSet(&tileset, CreateTilesSet());
-                while (tile)
-                {
-                    AddTileToSortedTileSet(&tileset, CreateTile(tile->number, tile->color));
-                    tile = tile->next_tile;
-                }
-                
-            }
-            else if(cursor->number == 4)
-            {
-                struct Tile_s* tile = cursor->tiles;
-                AddTileSetToTileSet(&tileset, CreateTilesSet());
-                while(tile)
-                {
-                    AddTileToSortedTileSet(&tileset, CreateTile(tile->number, tile->color));
-                    tile = tile->next_tile;
-                }
-                int i = 0;
-                //cursor = RemoveDoublons(cursor);
-                while(i <= 3)
-                {
-                    struct Tile_s* tile = cursor->tiles;
-                    AddTileSetToTileSet(&tileset, CreateTilesSet());
-                    for (int j = 0; j <= 3; j++, tile = tile->next_tile)
-                    {
-                        if(j == i)
-                            continue;
-                        AddTileToSortedTileSet(&tileset, CreateTile(tile->number, tile->color));
-                    }
-                    
-                    i++;
-                }
-
-            }
-    
-    }
-    return tileset;
-}
-
 // Return a copy of a given tile set
 struct TileSet_s* CopyTileSet(struct TileSet_s* tileset){
     if(!tileset)
@@ -489,7 +493,7 @@ void RemoveTileFromTileSet(struct TileSet_s* tileset, int number, int color){
                 if(cursor->next_tile)
                     cursor->next_tile->previous_tile = NULL;
             }
-            free(cursor);
+            ReleaseTile(cursor);
             tileset->number--;
             return;
         }
@@ -569,67 +573,24 @@ int GetScoreFromTileSet(struct TileSet_s* tileset)
     return score;
 }
 
-struct TileSet_s* GetAllCombinations(struct TileSet_s* tileset)
+// Return the runs and groups that can be made with the tiles of the tile set and place the highest score
+struct TileSet_s* GetAllCombinations(struct TileSet_s* tileset, const struct Rummikub_s* solver)
 {
-    tileset = RemoveDoublons(tileset);
-    struct TileSet_s* runs_tileset = GetAdjacentTileSets(tileset);
-    struct TileSet_s* runs_tileset_combinations = GetAdjacentTileSetsCombinations(runs_tileset);
+    struct TileBitboard_s tiles = GetBitboardFromTileSet(tileset);
+    struct TileBitboard_s melds[NB_MELDS];
+    int nb_melds = GetRummikubMelds(solver, tiles, melds);
     printf("Possible runs :\n");
-    PrintTileSets(runs_tileset_combinations);
-    FreeTileSet(runs_tileset);
-
-    struct TileSet_s** groups_tilesets = SplitTileSetByNumber(tileset);
-    struct TileSet_s* groups_tileset_combinations = GetNumberTileSetsCombinations(groups_tilesets);
+    PrintMelds(melds, nb_melds, true);
     printf("Possible groups :\n");
-    PrintTileSets(groups_tileset_combinations);
-    FreeTileSet(groups_tilesets);
-
-    struct TileSet_s* copy_tileset = CopyTileSet(tileset);
-    AddTileSetToTileSetQueu(&runs_tileset_combinations, groups_tileset_combinations);
-    struct TileSet_s* possible_combinations_tileset = runs_tileset_combinations;
-
-    struct TileSet_s* cursor = possible_combinations_tileset;
-    if(!cursor)
+    PrintMelds(melds, nb_melds, false);
+    if(!nb_melds)
         return NULL;
-    struct TileSet_s* combinations_tileset = NULL;
-    struct TileSet_s* cursor2;
-
-    struct TileSet_s* best_score_set = NULL;
-    int best_score = INT_MIN;
-    while(cursor)
-    {
-        cursor2 = cursor->next_set;
-        copy_tileset = CopyTileSet(tileset);
-        // Remove cursor from possible_combinations_tileset
-        RemoveTilesFromTileSet(copy_tileset, cursor);
-        // Add cursor to combinations_tileset
-        AddTileSetToTileSet(&combinations_tileset, CopyTileSet(cursor));
-
-        while(cursor2)
-        {
-            // Is cursor2 a subset of possible_combinations_tileset ?
-            if(IsTileSetSubsetOf(cursor2, copy_tileset))
-            {
-                // Remove cursor2 from possible_combinations_tileset
-                RemoveTilesFromTileSet(copy_tileset, cursor2);
-                // Add cursor2 to combinations_tileset
-                AddTilesFromTileSetToTileSet(combinations_tileset, cursor2);
-            }
-            cursor2 = cursor2->next_set;
-        }
-        cursor = cursor->next_set;
-        int score = GetScoreFromTileSet(combinations_tileset);
-        if (score > best_score)
-        {
-            best_score = score;
-            best_score_set = combinations_tileset;
-        }
 
-        FreeTileSet(copy_tileset);
-    }
+    struct TableState_s best_sets;
+    SolveRummikubRack(solver, tiles, &best_sets, NULL);
     printf("Best Score combinations :\n");
-    PrintTileSet(best_score_set);
-    return combinations_tileset;
+    PrintTableState(&best_sets);
+    return GetTileSetsFromTableState(&best_sets);
 }
 
 // Check if the given tile set is a run
@@ -775,20 +736,6 @@ bool isPartialSet(struct TileSet_s* tileset)
     return false;
 }
 
-float heuristic(struct TileSet_s* tileset)
-{
-    int nb_partials_sets = 0;
-    struct TileSet_s* cursor = tileset;;
-    while(cursor)
-    {
-        if(isPartialSet(cursor))
-            nb_partials_sets++;
-
-        cursor = cursor->next_set;
-    }
-    return (float)nb_partials_sets/2;
-}
-
 // Move one tile from a tile set to another tile set
 void MoveTileFromTileSetToTileSet(struct TileSet_s* to_tileset, struct Tile_s* tile)
 {
@@ -813,29 +760,40 @@ void RemoveSpaceFromString(char* s) {
 struct TileSet_s* GetTileSetFromString(char* string)
 {
     struct TileSet_s* tileset = NULL;
-    char buffer[100];
-    strcpy(buffer, string);
-    char* token = strtok(buffer, ",");
+    char* buffer = strdup(string);
+    if(!buffer)
+        return NULL;
+    char* save;
+    char* token = strtok_r(buffer, ",", &save);
     char* cursor;
     while(token)
     {
         cursor = token;
+        // Skip the empty sets, a set ends at the next comma or at the end of the line
+        if(*cursor == '\0' || *cursor == '\n')
+        {
+            token = strtok_r(NULL, ",", &save);
+            continue;
+        }
         AddTileSetToTileSet(&tileset, CreateTilesSet());
-        while(*cursor != '\n')
+        while(*cursor != '\n' && *cursor != '\0')
         {
             int number = 0;
             char color = 0;
             while(isdigit(*cursor))
             {
                 number = number * 10 + (*cursor - '0');
-                if(number < 1  || number > 13)
-                {
-                    printf("Error : Invalid number in string : %s\n", string);
-                    FreeTileSets(tileset);
-                    return NULL;
-                }
+                if(number > 13)
+                    break;
                 cursor++;
             }
+            if(number < 1  || number > 13)
+            {
+                fprintf(stderr, "Error : Invalid number in string : %s\n", string);
+                FreeTileSets(tileset);
+                free(buffer);
+                return NULL;
+            }
             if(*cursor == 'R')
                 color = 'R';
             else if(*cursor == 'B')
@@ -845,15 +803,17 @@ struct TileSet_s* GetTileSetFromString(char* string)
             else if(*cursor == 'Y')
                 color = 'Y';
             else{
-                printf("Error : invalid color %c\n", *cursor);
+                fprintf(stderr, "Error : invalid color %c\n", *cursor);
                 FreeTileSets(tileset);
+                free(buffer);
                 return NULL;
             }            
             AddTileToTileSetQueue(tileset, CreateTile(number, color));
             cursor++;
         }
-        token = strtok(NULL, ",");
+        token = strtok_r(NULL, ",", &save);
     }
+    free(buffer);
     return tileset;
 }
 
@@ -906,16 +866,18 @@ bool areValidSets(struct TileSet_s* tileset)
 }
 
 
-int GetMenuSelection()
+int GetMenuSelection(const struct SolverOptions_s* options)
 {
     int selection = 0;
-    while(selection < 1 || selection > 5)
+    while(selection < 1 || selection > 7)
     {
         printf("1 - Create a player tile set\n");
         printf("2 - Create a table tile set\n");
         printf("3 - Get all possible combinations of a tile set\n");
         printf("4 - Get a move to play for the player\n");
-        printf("5 - Exit\n");
+        printf("5 - Switch solver (current : %s)\n", options->engine == ENGINE_DP ? "exact" : "A*");
+        printf("6 - Switch the value maximized by the exact solver (current : %s)\n", options->objective == OBJECTIVE_SCORE ? "score" : "tiles");
+        printf("7 - Exit\n");
         printf("Enter your selection : ");
         // Check if the input is a number
         char* string = GetStringInput();
@@ -928,7 +890,7 @@ int GetMenuSelection()
             selection = 0;
         }
         free(string);
-        if(selection < 1 || selection > 5)
+        if(selection < 1 || selection > 7)
             printf("Invalid selection\n");
          /*int c;
         while ((c = getchar()) != '\n' && c != EOF);*/
@@ -937,16 +899,23 @@ int GetMenuSelection()
 }
 
 // Main loop based on return value from GetMenuSelection()
-void MainLoop()
+int MainLoop(struct SolverOptions_s options)
 {
+    const char* error;
+    struct Rummikub_s* solver = CreateRummikub(&options, &error);
+    if(!solver)
+    {
+        fprintf(stderr, "Error : %s\n", error);
+        return EXIT_FAILURE;
+    }
     int selection = 0;
     struct TileSet_s* player_tileset = NULL;
     struct TileSet_s* table_tileset = NULL;
 
     struct TileSet_s* player_table_tileset = NULL;
-    while(selection != 5)
+    while(selection != 7)
     {
-        selection = GetMenuSelection();
+        selection = GetMenuSelection(&options);
         if(selection == 1)
         {
             if(player_tileset)
@@ -980,10 +949,10 @@ void MainLoop()
                 printf("You must create a tile set first\n");
                 continue;
             }
-            struct TileSet_s* combinations_tileset = GetAllCombinations(player_tileset);
+            struct TileSet_s* combinations_tileset = GetAllCombinations(player_tileset, solver);
             if(!combinations_tileset)
                 printf("No possible combinations\n");
-            FreeTileSet(combinations_tileset);
+            FreeTileSets(combinations_tileset);
         }
         printf("\033[2J\033[1;1H");
         if(player_tileset)
@@ -1009,7 +978,25 @@ void MainLoop()
                 printf("You must create a tile set first\n");
                 continue;
             }
-            AStar(player_tileset, table_tileset);
+            PrintBestMove(solver, player_tileset, table_tileset);
+        }
+        if(selection == 5 || selection == 6)
+        {
+            // The handle keeps the threads of its engine and its options, switching one gets a new handle
+            struct SolverOptions_s switched_options = options;
+            if(selection == 5)
+                switched_options.engine = options.engine == ENGINE_DP ? ENGINE_ASTAR : ENGINE_DP;
+            else
+                switched_options.objective = options.objective == OBJECTIVE_SCORE ? OBJECTIVE_TILES : OBJECTIVE_SCORE;
+            struct Rummikub_s* switched_solver = CreateRummikub(&switched_options, &error);
+            if(!switched_solver)
+            {
+                printf("Error : %s\n", error);
+                continue;
+            }
+            FreeRummikub(solver);
+            solver = switched_solver;
+            options = switched_options;
         }
     }
 
@@ -1017,57 +1004,12 @@ void MainLoop()
         FreeTileSets(player_tileset);
     if(table_tileset)
         FreeTileSets(table_tileset);
+    FreeRummikub(solver);
     printf("\033[2J\033[1;1H");
     printf("Exiting\n");
+    return EXIT_SUCCESS;
 }
 
-struct PriorityQueue_s* CreatePriorityQueue(struct TileSet_s* tileset, struct PriorityQueue_s* previous_queue, int depth)
-{
-    struct PriorityQueue_s* queue = malloc(sizeof(struct PriorityQueue_s));
-    queue->tile_set = CopyTileSets(tileset);
-    queue->h = heuristic(tileset);
-    queue->g = depth;
-    queue->next_set = NULL;
-    queue->previous_set = previous_queue;
-    return queue;
-}
-
-void AddToPriorityQueue(struct PriorityQueue_s** queue, struct PriorityQueue_s* new_queue)
-{
-    if(!*queue)
-    {
-        *queue = new_queue;
-        return;
-    }
-    if((float)(new_queue->g + new_queue->h) < (float)((*queue)->g + (*queue)->h))
-    {
-        new_queue->next_set = *queue;
-        *queue = new_queue;
-        return;
-    }
-    struct PriorityQueue_s* current = *queue;
-    while(current->next_set)
-    {
-        if((float)(new_queue->g + new_queue->h) < (float)(current->next_set->g + current->next_set->h))
-        {
-            new_queue->next_set = current->next_set;
-            current->next_set = new_queue;
-            return;
-        }
-        current = current->next_set;
-    }
-    current->next_set = new_queue;
-}
-
-struct PriorityQueue_s* PopFromPriorityQueue(struct PriorityQueue_s** queue)
-{
-    if(!queue)
-        return NULL;
-    struct PriorityQueue_s* current = *queue;
-    *queue = (*queue)->next_set;
-    current->next_set = NULL;
-    return current;
-}
 // Remove tile set from tile set list
 void RemoveTileSet(struct TileSet_s** tileset_to_remove)
 {
@@ -1080,573 +1022,1241 @@ void RemoveTileSet(struct TileSet_s** tileset_to_remove)
     (*tileset_to_remove) = (*tileset_to_remove)->next_set;
 }
 
-// Get shortest non valid set 
-struct TileSet_s* GetShortestNonValidSet(struct TileSet_s* tileset)
+// Remove first tile from tileset
+struct Tile_s* RemoveFirstTileFromTileSet(struct TileSet_s* tileset)
 {
-    int min_number = INT_MAX;
-    struct TileSet_s* min_set = NULL;
-    struct TileSet_s* cursor = tileset;
-    while(cursor)
-    {
-        if(!isValidSet(cursor) && cursor->number < min_number)
-        {
-            min_number = cursor->number;
-            min_set = cursor;
-        }
-    
-        cursor = cursor->next_set;
-    }
-    return min_set;
+    struct Tile_s* first_tile = tileset->tiles;
+    if(tileset->tiles->next_tile)
+        tileset->tiles->next_tile->previous_tile = NULL;
+    tileset->tiles = tileset->tiles->next_tile;
+
+    tileset->number--;
+    return first_tile;
 }
 
-struct Tile_s** wichTilesCanAddOnStart(struct TileSet_s* illegal_tileset, struct TileSet_s* tileset)
+// Remove last tile from tileset
+struct Tile_s* RemoveLastTileFromTileSet(struct TileSet_s* tileset)
 {
+    struct Tile_s* last_tile = tileset->last_tile;
+    if(tileset->last_tile->previous_tile)
+        tileset->last_tile->previous_tile->next_tile = NULL;
+    tileset->last_tile = tileset->last_tile->previous_tile;
 
-    // Store the tiles pointer in a array
-    struct Tile_s** set_to_add = calloc(10, sizeof(struct Tile_s*));
-    int idx = 0;
-    struct Tile_s* tile_cursor = tileset->tiles;
-    struct TileSet_s* tileset_cursor = tileset;
-    if(!tile_cursor)
-        return set_to_add;
-    // if the first tile of the illegal set is superior to 1 we can complete it with 2, 3, 4...
-    if((illegal_tileset->tiles->number > 1) )
-    {
-        // Search a tile for completion
-        while(tileset_cursor)
-        {
-            tile_cursor = tileset_cursor->tiles;
-            while(tile_cursor)
-            {
-                if((tile_cursor->number == illegal_tileset->tiles->number - 1) && (tile_cursor->color == illegal_tileset->tiles->color))
-                    set_to_add[idx++] = tile_cursor;
-                tile_cursor = tile_cursor->next_tile;
-            }
-            tileset_cursor = tileset_cursor->next_set;
-        }
-    }
+    tileset->number--;
+    return last_tile;
+}
 
-    if(illegal_tileset->number < 4)
+bool IsTileInMovedTiles(struct Tile_s* tile, struct Tile_s** moved_tiles, int nb_moved_tiles)
+{
+    int i = 0;
+    while(i < nb_moved_tiles)
     {
-        bool red = false, green = false, blue = false, yellow = false;
-        struct Tile_s* cursor = illegal_tileset->tiles;
-        while(cursor)
-        {
-            switch(cursor->color)
-            {
-                case 'R':
-                    red = true;
-                    break;
-                case 'G':
-                    green = true;
-                    break;
-                case 'B':
-                    blue = true;
-                    break;
-                case 'Y':
-                    yellow = true;
-                    break;
-            }
-            cursor = cursor->next_tile;
-        }
-
-        tile_cursor = tileset->tiles;
-        tileset_cursor = tileset;
-    
-        // Search a tile for completion
-        while(tileset_cursor)
-        {
-            tile_cursor = tileset_cursor->tiles;
-            while(tile_cursor)
-            {
-                if(!red && (tile_cursor->number == illegal_tileset->tiles->number) && (tile_cursor->color == 'R'))
-                    set_to_add[idx++] = tile_cursor;
-                if(!green && (tile_cursor->number == illegal_tileset->tiles->number) && (tile_cursor->color == 'G'))
-                    set_to_add[idx++] = tile_cursor;
-                if(!blue && (tile_cursor->number == illegal_tileset->tiles->number) && (tile_cursor->color == 'B'))
-                    set_to_add[idx++] = tile_cursor;
-                if(!yellow && (tile_cursor->number == illegal_tileset->tiles->number) && (tile_cursor->color == 'Y'))
-                    set_to_add[idx++] = tile_cursor;
-                tile_cursor = tile_cursor->next_tile;
-            }
-            tileset_cursor = tileset_cursor->next_set;
-        }
+        if(moved_tiles[i] == tile)
+            return true;
+        i++;
     }
- 
-    return set_to_add;
+    return false;
 }
 
-struct Tile_s** wichTilesCanAddOnEnd(struct TileSet_s* illegal_tileset, struct TileSet_s* tileset)
+// Realloc moved tiles array to add a new tile
+void CheckMovedTilesBounds(struct Tile_s** moved_tiles, int nb_moved_tiles, int* nb_moved_tiles_max)
 {
-    // Store the tiles pointer in a array
-    struct Tile_s** set_to_add = calloc(10, sizeof(struct Tile_s*));
-    int idx = 0;
-    struct Tile_s* tile_cursor = tileset->tiles;
-    struct TileSet_s* tileset_cursor = tileset;
-    if(!tile_cursor)
-        return set_to_add;
-    // if the first tile of the illegal set is superior to 1 we can complete it with 2, 3, 4...
-    if(illegal_tileset->last_tile->number < 13)
-    {
-        // Search a tile for completion
-        while(tileset_cursor)
+    if(nb_moved_tiles >= *nb_moved_tiles_max)
+    {
+        *nb_moved_tiles_max += 100;
+        struct Tile_s** new_moved_tiles = realloc(moved_tiles, *nb_moved_tiles_max * sizeof(struct Tile_s*));
+        if(!new_moved_tiles)
         {
-            tile_cursor = tileset_cursor->tiles;
-            while(tile_cursor)
-            {
-                if((tile_cursor->number == illegal_tileset->tiles->number + 1) && (tile_cursor->color == illegal_tileset->tiles->color))
-                    set_to_add[idx++] = tile_cursor;
-                tile_cursor = tile_cursor->next_tile;
-            }
-            tileset_cursor = tileset_cursor->next_set;
+            printf("Error: realloc failed\n");
+            exit(EXIT_FAILURE);
         }
+        moved_tiles = new_moved_tiles;
     }
-     if(illegal_tileset->number < 4)
+ }
+
+#ifdef RUMMIKUB_STATS
+// Print the counters of a solve as one JSON line
+void PrintSearchStats(FILE* output, const char* solver, const struct SearchStats_s* stats)
+{
+    static const char* move_names[NB_MOVE_KINDS] = {"to_set", "on_start", "on_end", "split"};
+    static const char* timer_names[NB_STATS_TIMERS] = {"copy", "heuristic", "validity", "insertion"};
+    fprintf(output, "{\"stats\":\"%s\",\"nodes\":%lu,\"successors\":{", solver, stats->nb_nodes);
+    for(int kind = 0; kind < NB_MOVE_KINDS; kind++)
+        fprintf(output, "%s\"%s\":%lu", kind ? "," : "", move_names[kind], stats->successors[kind]);
+    fprintf(output, "},\"duplicates\":%lu,\"reopened\":%lu,\"pruned\":%lu,\"peak_frontier\":%d,\"arena_bytes\":%zu,\"cycles\":{",
+            stats->duplicates, stats->reopened, stats->pruned, stats->peak_frontier, stats->arena_bytes);
+    for(int timer = 0; timer < NB_STATS_TIMERS; timer++)
+        fprintf(output, "%s\"%s\":%llu", timer ? "," : "", timer_names[timer], (unsigned long long)stats->cycles[timer]);
+    fprintf(output, "}}\n");
+}
+#endif
+
+// Print the best placement of the rack found by the solver
+void PrintBestMove(struct Rummikub_s* solver, const struct TileSet_s* player_tileset, const struct TileSet_s* table_tileset)
+{
+    struct TableState_s table_state;
+    if(!GetTableStateFromTileSets(table_tileset, &table_state))
     {
-        bool red = false, green = false, blue = false, yellow = false;
-        struct Tile_s* cursor = illegal_tileset->tiles;
-        while(cursor)
+        printf("Error : too many sets on the table\n");
+        return;
+    }
+    struct TileBitboard_s rack_tiles = {0, 0};
+    bool valid_copies = AddTileSetsToBitboard(&rack_tiles, player_tileset);
+    struct TileBitboard_s game_tiles = rack_tiles;
+    if(!valid_copies || !AddTileSetsToBitboard(&game_tiles, table_tileset))
+    {
+        printf("Error : more than two copies of a tile\n");
+        return;
+    }
+    struct Placement_s placement;
+    const char* error = SolveRummikub(solver, rack_tiles, &table_state, &placement);
+    if(error)
+    {
+        printf("Error : %s\n", error);
+        return;
+    }
+#ifdef RUMMIKUB_STATS
+    PrintSearchStats(stderr, GetRummikubOptions(solver)->engine == ENGINE_DP ? "dp" : "astar", &placement.stats);
+#endif
+    printf("Best placement : %d tiles, score %d\n", placement.nb_placed_tiles, placement.score);
+    printf("Placed tiles :\n");
+    printf(" ");
+    PrintBitboard(placement.placed_tiles);
+    printf("\n");
+    printf("Steps :\n");
+    for(int i = 0; i < placement.nb_steps && i < MAX_PLACEMENT_STEPS; i++)
+    {
+        const struct PlacementStep_s* step = &placement.steps[i];
+        printf(" %d. place ", i + 1);
+        PrintBitboard(step->placed_tiles);
+        printf(" :");
+        for(int j = 0; j < step->nb_sets; j++)
         {
-            switch(cursor->color)
-            {
-                case 'R':
-                    red = true;
-                    break;
-                case 'G':
-                    green = true;
-                    break;
-                case 'B':
-                    blue = true;
-                    break;
-                case 'Y':
-                    yellow = true;
-                    break;
-            }
-            cursor = cursor->next_tile;
+            printf(" ");
+            PrintBitboard(step->sets[j]);
+            printf(" ");
         }
+        printf("\n");
+    }
+    if(placement.nb_steps > MAX_PLACEMENT_STEPS)
+        printf(" ... %d more steps\n", placement.nb_steps - MAX_PLACEMENT_STEPS);
+    printf("Table :\n");
+    PrintTableState(&placement.table_state);
+}
 
-        tile_cursor = tileset->tiles;
-        tileset_cursor = tileset;
-    
-        // Search a tile for completion
-        while(tileset_cursor)
+// Return the microseconds elapsed since the start time
+double GetElapsedMicroseconds(const struct timespec* start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1e6 + (now.tv_nsec - start->tv_nsec) / 1e3;
+}
+
+// Print the tiles of a bitboard as a JSON array of strings : ["1R","2R","3R"]
+static void PrintJsonTiles(FILE* output, struct TileBitboard_s tiles)
+{
+    bool first = true;
+    fputc('[', output);
+    for(int copy = 0; copy < 2; copy++)
+    {
+        uint64_t word = copy ? tiles.two : tiles.one;
+        while(word)
         {
-            tile_cursor = tileset_cursor->tiles;
-            while(tile_cursor)
-            {
-                if(!red && (tile_cursor->number == illegal_tileset->tiles->number) && (tile_cursor->color == 'R'))
-                    set_to_add[idx++] = tile_cursor;
-                if(!green && (tile_cursor->number == illegal_tileset->tiles->number) && (tile_cursor->color == 'G'))
-                    set_to_add[idx++] = tile_cursor;
-                if(!blue && (tile_cursor->number == illegal_tileset->tiles->number) && (tile_cursor->color == 'B'))
-                    set_to_add[idx++] = tile_cursor;
-                if(!yellow && (tile_cursor->number == illegal_tileset->tiles->number) && (tile_cursor->color == 'Y'))
-                    set_to_add[idx++] = tile_cursor;
-                tile_cursor = tile_cursor->next_tile;
-            }
-            tileset_cursor = tileset_cursor->next_set;
+            int bit = __builtin_ctzll(word);
+            word &= word - 1;
+            fprintf(output, "%s\"%d%c\"", first ? "" : ",", GetBitNumber(bit), GetBitColor(bit));
+            first = false;
         }
     }
-    
-    return set_to_add;
+    fputc(']', output);
 }
 
-// Remove first tile from tileset
-struct Tile_s* RemoveFirstTileFromTileSet(struct TileSet_s* tileset)
+// Print the tiles of a bitboard in the menu input format : 1R 2R 3R
+static void PrintTextTiles(FILE* output, struct TileBitboard_s tiles)
 {
-    struct Tile_s* first_tile = tileset->tiles;
-    if(tileset->tiles->next_tile)
-        tileset->tiles->next_tile->previous_tile = NULL;
-    tileset->tiles = tileset->tiles->next_tile;
+    uint8_t ids[NB_TILES];
+    int nb_ids = GetTileIdsFromBitboard(tiles, ids);
+    for(int i = 0; i < nb_ids; i++)
+    {
+        int bit = GetTileIdBit(ids[i]);
+        fprintf(output, "%s%d%c", i ? " " : "", GetBitNumber(bit), GetBitColor(bit));
+    }
+}
 
-    tileset->number--;
-    return first_tile;
+// Print a game state line "rack ; table" as read by the batch mode, the sets are printed from the last one since
+// the line parser lists them in reverse order
+void PrintGameStateLine(FILE* output, struct TileBitboard_s rack_tiles, const struct TableState_s* table_state)
+{
+    PrintTextTiles(output, rack_tiles);
+    fprintf(output, " ;");
+    for(int i = table_state->nb_sets - 1; i >= 0; i--)
+    {
+        fprintf(output, i < table_state->nb_sets - 1 ? ", " : " ");
+        PrintTextTiles(output, table_state->sets[i]);
+    }
+    fputc('\n', output);
 }
 
-// Remove last tile from tileset
-struct Tile_s* RemoveLastTileFromTileSet(struct TileSet_s* tileset)
+// Print one line of batch result, the placement is only printed when error is NULL
+static void PrintBatchResult(FILE* output, unsigned long line_number, enum SolverEngine_e engine, const char* error, const struct Placement_s* placement, double time_us)
 {
-    struct Tile_s* last_tile = tileset->last_tile;
-    if(tileset->last_tile->previous_tile)
-        tileset->last_tile->previous_tile->next_tile = NULL;
-    tileset->last_tile = tileset->last_tile->previous_tile;
+    fprintf(output, "{\"line\":%lu,\"engine\":\"%s\"", line_number, engine == ENGINE_DP ? "dp" : "astar");
+    if(error)
+    {
+        fprintf(output, ",\"status\":\"error\",\"error\":\"%s\"}\n", error);
+        return;
+    }
+    fprintf(output, ",\"status\":\"ok\",\"tiles\":%d,\"score\":%d,\"placed\":", placement->nb_placed_tiles, placement->score);
+    PrintJsonTiles(output, placement->placed_tiles);
+    fprintf(output, ",\"melds\":[");
+    for(int i = 0; i < placement->table_state.nb_sets; i++)
+    {
+        if(i)
+            fputc(',', output);
+        PrintJsonTiles(output, placement->table_state.sets[i]);
+    }
+    fprintf(output, "]");
+    if(placement->timed_out)
+        fprintf(output, ",\"timed_out\":true");
+    fprintf(output, ",\"time_us\":%.1f}\n", time_us);
+}
 
-    tileset->number--;
-    return last_tile;
+// Parse a game state line "rack ; table" where the table sets are separated by commas,
+// return the error message or NULL
+const char* GetGameStateFromString(char* line, struct TileBitboard_s* rack_tiles, struct TableState_s* table_state)
+{
+    char* separator = strchr(line, ';');
+    if(!separator)
+        return "missing ';' between rack and table";
+    *separator = '\0';
+    char* table_string = separator + 1;
+    RemoveSpaceFromString(line);
+    RemoveSpaceFromString(table_string);
+
+    // An empty rack is a game state too, like the ones written by the binary encoding
+    *rack_tiles = (struct TileBitboard_s){0, 0};
+    if(*line != '\0' && *line != '\n')
+    {
+        struct TileSet_s* rack_tileset = GetTileSetFromString(line);
+        if(!rack_tileset)
+            return "invalid rack";
+        // The game has two copies of each tile, counted over the rack and the table
+        bool valid_copies = AddTileSetsToBitboard(rack_tiles, rack_tileset);
+        FreeTileSets(rack_tileset);
+        if(!valid_copies)
+            return "more than two copies of a tile";
+    }
+
+    InitTableState(table_state);
+    if(*table_string == '\0' || *table_string == '\n')
+        return NULL;
+    struct TileSet_s* table_tileset = GetTileSetFromString(table_string);
+    if(!table_tileset)
+        return "invalid table";
+    struct TileBitboard_s game_tiles = *rack_tiles;
+    bool valid_copies = AddTileSetsToBitboard(&game_tiles, table_tileset);
+    bool valid = valid_copies && areValidSets(table_tileset) && GetTableStateFromTileSets(table_tileset, table_state);
+    FreeTileSets(table_tileset);
+    if(!valid_copies)
+        return "more than two copies of a tile";
+    return valid ? NULL : "invalid table sets";
+}
+
+// Solve a game state and print its JSON result line, the state is not solved when error is already set
+static void AnswerGameState(unsigned long line_number, FILE* output, struct Rummikub_s* solver, const char* error, struct TileBitboard_s rack_tiles, const struct TableState_s* table_state)
+{
+    struct Placement_s placement;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if(!error)
+        error = SolveRummikub(solver, rack_tiles, table_state, &placement);
+    double time_us = GetElapsedMicroseconds(&start);
+    enum SolverEngine_e engine = GetRummikubOptions(solver)->engine;
+#ifdef RUMMIKUB_STATS
+    if(!error)
+        PrintSearchStats(stderr, engine == ENGINE_DP ? "dp" : "astar", &placement.stats);
+#endif
+    PrintBatchResult(output, line_number, engine, error, &placement, time_us);
+    fflush(output);
+}
+
+// Solve a game state line "rack ; table" and print its JSON result line, empty lines and lines starting with '#'
+// are skipped
+void AnswerGameStateLine(char* line, unsigned long line_number, FILE* output, struct Rummikub_s* solver)
+{
+    if(line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0')
+        return;
+    line[strcspn(line, "\r\n")] = '\0';
+
+    struct TileBitboard_s rack_tiles;
+    struct TableState_s table_state;
+    const char* error = GetGameStateFromString(line, &rack_tiles, &table_state);
+    AnswerGameState(line_number, output, solver, error, rack_tiles, &table_state);
 }
 
-bool IsTileInMovedTiles(struct Tile_s* tile, struct Tile_s** moved_tiles, int nb_moved_tiles)
+// Solve the game states read line by line from the input and print one JSON result line per state,
+// empty lines and lines starting with '#' are skipped
+int RunBatch(FILE* input, struct Rummikub_s* solver)
 {
-    int i = 0;
-    while(i < nb_moved_tiles)
+    char* line = NULL;
+    size_t line_size = 0;
+    unsigned long line_number = 0;
+    while(getline(&line, &line_size, input) != -1)
+        AnswerGameStateLine(line, ++line_number, stdout, solver);
+    free(line);
+    return EXIT_SUCCESS;
+}
+
+// Read a binary game state in buffer, return its size, 0 at the end of the input or -1 if the state is cut
+static int ReadGameStateRecord(FILE* input, uint8_t* buffer)
+{
+    size_t size = fread(buffer, 1, GAME_STATE_HEADER_BYTES, input);
+    if(!size)
+        return 0;
+    size_t nb_tiles = buffer[0] + buffer[1];
+    if(size < GAME_STATE_HEADER_BYTES || nb_tiles > NB_TILES || fread(buffer + GAME_STATE_HEADER_BYTES, 1, nb_tiles, input) != nb_tiles)
+        return -1;
+    return GAME_STATE_HEADER_BYTES + nb_tiles;
+}
+
+// Solve the binary game states read from the input and print one JSON result line per state, numbered like lines
+int RunBinaryBatch(FILE* input, struct Rummikub_s* solver)
+{
+    uint8_t buffer[GAME_STATE_MAX_BYTES];
+    unsigned long number = 0;
+    int size;
+    while((size = ReadGameStateRecord(input, buffer)) > 0)
     {
-        if(moved_tiles[i] == tile)
-            return true;
-        i++;
+        struct TileBitboard_s rack_tiles;
+        struct TableState_s table_state;
+        const char* error = DecodeGameState(buffer, size, &rack_tiles, &table_state);
+        AnswerGameState(++number, stdout, solver, error, rack_tiles, &table_state);
     }
-    return false;
+    if(size < 0)
+    {
+        fprintf(stderr, "Error : game state %lu is cut\n", number + 1);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
 }
 
-// Realloc moved tiles array to add a new tile
-void CheckMovedTilesBounds(struct Tile_s** moved_tiles, int nb_moved_tiles, int* nb_moved_tiles_max)
+// Write the binary game states of the game state lines of the input, the lines that cannot be read are reported
+int EncodeGameStates(FILE* input, FILE* output)
 {
-    if(nb_moved_tiles >= *nb_moved_tiles_max)
-    {
-        *nb_moved_tiles_max += 100;
-        struct Tile_s** new_moved_tiles = realloc(moved_tiles, *nb_moved_tiles_max * sizeof(struct Tile_s*));
-        if(!new_moved_tiles)
+    char* line = NULL;
+    size_t line_size = 0;
+    unsigned long line_number = 0;
+    int status = EXIT_SUCCESS;
+    while(getline(&line, &line_size, input) != -1)
+    {
+        line_number++;
+        if(line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0')
+            continue;
+        line[strcspn(line, "\r\n")] = '\0';
+        struct TileBitboard_s rack_tiles;
+        struct TableState_s table_state;
+        uint8_t buffer[GAME_STATE_MAX_BYTES];
+        const char* error = GetGameStateFromString(line, &rack_tiles, &table_state);
+        int size = error ? -1 : EncodeGameState(rack_tiles, &table_state, buffer);
+        if(size < 0)
         {
-            printf("Error: realloc failed\n");
-            exit(EXIT_FAILURE);
+            fprintf(stderr, "Error : line %lu : %s\n", line_number, error ? error : "more than two copies of a tile");
+            status = EXIT_FAILURE;
+            continue;
         }
-        moved_tiles = new_moved_tiles;
+        fwrite(buffer, 1, size, output);
     }
- }
+    free(line);
+    return status;
+}
 
-// Realloc queue to free if the queue is full
-void CheckQueueBounds(struct PriorityQueue_s*** queue, int nb_queue, int* nb_queue_max)
+// Print the game state line of each binary game state of the input
+int DecodeGameStates(FILE* input, FILE* output)
 {
-    if(nb_queue >= *nb_queue_max)
-    {
-        *nb_queue_max += 100;
-        struct PriorityQueue_s** new_queue = realloc(*queue, *nb_queue_max * sizeof(struct PriorityQueue_s*));
-        if(!new_queue)
+    uint8_t buffer[GAME_STATE_MAX_BYTES];
+    unsigned long number = 0;
+    int status = EXIT_SUCCESS;
+    int size;
+    while((size = ReadGameStateRecord(input, buffer)) > 0)
+    {
+        struct TileBitboard_s rack_tiles;
+        struct TableState_s table_state;
+        const char* error = DecodeGameState(buffer, size, &rack_tiles, &table_state);
+        number++;
+        if(error)
         {
-            printf("Error: realloc failed\n");
-            exit(EXIT_FAILURE);
+            fprintf(stderr, "Error : game state %lu : %s\n", number, error);
+            status = EXIT_FAILURE;
+            continue;
         }
-        *queue = new_queue;
+        PrintGameStateLine(output, rack_tiles, &table_state);
+    }
+    if(size < 0)
+    {
+        fprintf(stderr, "Error : game state %lu is cut\n", number + 1);
+        return EXIT_FAILURE;
     }
+    return status;
+}
 
+// Close the connection of a server client and remove it from the clients
+static void CloseServerClient(struct ServerClient_s* clients, int* nb_clients, int index)
+{
+    free(clients[index].output);
+    close(clients[index].fd);
+    clients[index] = clients[--*nb_clients];
 }
 
-struct PriorityQueue_s* ResolvedTileset(struct TileSet_s* tileset, struct PriorityQueue_s* queue, struct PriorityQueue_s*** queue_to_free, int* free_idx)
+// Add the JSON result of a request line to the answers of a server client, return false when the answers not
+// sent pass the output limit
+static bool AnswerServerClient(struct ServerClient_s* client, char* line, const char* error, struct Rummikub_s* solver)
 {
-    int nb_queue_max = 100;
-    // While the priority queu is not empty
-    while(queue)
+    char* answer = NULL;
+    size_t answer_length = 0;
+    FILE* stream = open_memstream(&answer, &answer_length);
+    if(!stream)
+        return false;
+    if(error)
+        PrintBatchResult(stream, ++client->nb_requests, GetRummikubOptions(solver)->engine, error, NULL, 0);
+    else
+        AnswerGameStateLine(line, ++client->nb_requests, stream, solver);
+    fclose(stream);
+    char* output = client->output_length + answer_length <= SERVER_OUTPUT_LIMIT ? realloc(client->output, client->output_length + answer_length) : NULL;
+    if(output)
     {
-        // Pop the first element of the queue, wich is one table tile set after certain moves
-        struct PriorityQueue_s* best = PopFromPriorityQueue(&queue);
-        // If the best is a valid set
-        if(areValidSets(best->tile_set) && best->previous_set)
-        {   
-            return best;
+        memcpy(output + client->output_length, answer, answer_length);
+        client->output = output;
+        client->output_length += answer_length;
+    }
+    free(answer);
+    return output;
+}
+
+// Answer the complete lines received from a server client, return false when the client must be closed. At the
+// end of the connection a last line without newline is answered and the client is closed once its answers are sent
+static bool ReadServerClient(struct ServerClient_s* client, struct Rummikub_s* solver)
+{
+    ssize_t nb_read = read(client->fd, client->line + client->length, SERVER_LINE_SIZE - 1 - client->length);
+    if(nb_read < 0)
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    if(!nb_read)
+    {
+        client->closing = true;
+        client->line[client->length] = '\0';
+        return !client->length || AnswerServerClient(client, client->line, NULL, solver);
+    }
+    client->length += nb_read;
+    client->line[client->length] = '\0';
+    char* line = client->line;
+    char* end;
+    while((end = strchr(line, '\n')))
+    {
+        *end = '\0';
+        if(!AnswerServerClient(client, line, NULL, solver))
+            return false;
+        line = end + 1;
+    }
+    client->length -= line - client->line;
+    memmove(client->line, line, client->length);
+    // A line longer than the buffer cannot be answered
+    if(client->length < SERVER_LINE_SIZE - 1)
+        return true;
+    client->closing = true;
+    client->length = 0;
+    return AnswerServerClient(client, NULL, "line too long", solver);
+}
+
+// Send the answers of a server client the socket accepts without blocking, return false when the client must be closed
+static bool WriteServerClient(struct ServerClient_s* client)
+{
+    size_t nb_sent = 0;
+    while(nb_sent < client->output_length)
+    {
+        ssize_t nb_written = write(client->fd, client->output + nb_sent, client->output_length - nb_sent);
+        if(nb_written < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            if(errno != EAGAIN && errno != EWOULDBLOCK)
+                return false;
+            break;
         }
-        // If the search limit was exceed
-        if(best->g > 3)
-        {    
-            return NULL;
+        nb_sent += nb_written;
+    }
+    client->output_length -= nb_sent;
+    memmove(client->output, client->output + nb_sent, client->output_length);
+    return client->output_length || !client->closing;
+}
+
+// Serve the game state lines of the clients connecting to a Unix socket until the process is stopped. Each client
+// gets one JSON result line per request line, numbered from 1 for its connection. The solves run one at a time
+// with the warm state of the solver handle
+int RunServer(const char* socket_path, struct Rummikub_s* solver)
+{
+    struct sockaddr_un address = {0};
+    address.sun_family = AF_UNIX;
+    if(strlen(socket_path) >= sizeof(address.sun_path))
+    {
+        fprintf(stderr, "Error : the socket path %s is too long\n", socket_path);
+        return EXIT_FAILURE;
+    }
+    strcpy(address.sun_path, socket_path);
+    // A socket left by a stopped server is replaced
+    struct stat file_stat;
+    if(!stat(socket_path, &file_stat) && S_ISSOCK(file_stat.st_mode))
+        unlink(socket_path);
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listen_fd < 0 || bind(listen_fd, (struct sockaddr*)&address, sizeof(address)) < 0 || listen(listen_fd, MAX_SERVER_CLIENTS) < 0)
+    {
+        fprintf(stderr, "Error : cannot listen on %s\n", socket_path);
+        if(listen_fd >= 0)
+            close(listen_fd);
+        return EXIT_FAILURE;
+    }
+    // A client leaving before its answer is written must not stop the server
+    signal(SIGPIPE, SIG_IGN);
+
+    struct ServerClient_s* clients = malloc(MAX_SERVER_CLIENTS * sizeof(struct ServerClient_s));
+    struct pollfd fds[MAX_SERVER_CLIENTS + 1];
+    int nb_clients = 0;
+    while(clients)
+    {
+        fds[0] = (struct pollfd){listen_fd, POLLIN, 0};
+        // A closing client is only waited for until its answers are sent
+        for(int i = 0; i < nb_clients; i++)
+            fds[i + 1] = (struct pollfd){clients[i].fd, (clients[i].closing ? 0 : POLLIN) | (clients[i].output_length ? POLLOUT : 0), 0};
+        if(poll(fds, nb_clients + 1, -1) < 0)
+            continue;
+        // Clients are served from the last one so that closing a client does not move the ones left to serve
+        for(int i = nb_clients - 1; i >= 0; i--)
+        {
+            short events = fds[i + 1].revents;
+            bool open = true;
+            if(events & (POLLIN | POLLHUP | POLLERR) && !clients[i].closing)
+                open = ReadServerClient(&clients[i], solver);
+            else if(events & (POLLHUP | POLLERR))
+                open = false;
+            if(open && (events || clients[i].closing))
+                open = WriteServerClient(&clients[i]);
+            if(!open)
+                CloseServerClient(clients, &nb_clients, i);
         }
-        // Get the shortest non valid set from the table
-        struct TileSet_s* table_sets = CopyTileSets(best->tile_set);
-        struct TileSet_s* illegal_set = GetShortestNonValidSet(table_sets);
-        // Try to concatenate each tile from the illegal tile set to every other set
-        struct Tile_s* tile = illegal_set->tiles;
-        // Take each tile from the illegal set and try to concatenate it with every other set
-        while(tile)
+        if(fds[0].revents & POLLIN)
         {
-            // Get the table sets without the tile that we are trying to add
-            //table_sets = CopyTileSetsWithoutTile(best->tile_set, tile);
-            struct Tile_s* next_tile = tile->next_tile;
-            struct TileSet_s* cursor = table_sets;
-            while(cursor)
+            int fd = accept(listen_fd, NULL, NULL);
+            if(fd < 0)
+                continue;
+            // A client socket never blocks the server, its answers wait in its output until it reads them
+            if(nb_clients == MAX_SERVER_CLIENTS || fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) < 0)
             {
-                if(cursor == illegal_set)
-                {
-                    cursor = cursor->next_set;
-                    continue;
-                }
-                // Remove the tile from the illegal set
-                PopTileFromTileSet(&tile->tile_set->tiles, tile);
-                // Try to put the tile at the beggining of one of the sets
-                AddTileToTileSet(&cursor, tile);
-                // If the created set is semi legal add it to the priority queue
-                if((isPartialSet(cursor) || isValidSet(cursor)))
-                {
-                    // Put the tile at the start of the set
-                    struct PriorityQueue_s* new_queue = CreatePriorityQueue(table_sets, best, best->g + 1);
-                    AddToPriorityQueue(&queue, new_queue);  
-                    (*queue_to_free)[(*free_idx)++] = new_queue; 
-                    CheckQueueBounds(queue_to_free, *free_idx, &nb_queue_max);     
-                }           
-                // Remove the tile from the set
-                PopTileFromTileSet(&tile->tile_set->tiles, tile);
-                // Add the tile back to the illegal set
-                AddTileToTileSet(&illegal_set, tile);
-
-                // Remove the tile from the illegal set
-                PopTileFromTileSet(&tile->tile_set->tiles, tile);
-                // Try to put the tile at the end of one of the sets
-                PutTileAtEndOfTileSet(cursor, tile);
-                // If the created set is semi legal add it to the priority queue
-                if((isPartialSet(cursor) || isValidSet(cursor)))
-                 {
-                    // Put the tile at the start of the set
-                    struct PriorityQueue_s* new_queue = CreatePriorityQueue(table_sets, best, best->g + 1);
-                    AddToPriorityQueue(&queue, new_queue);  
-                    (*queue_to_free)[(*free_idx)++] = new_queue; 
-                    CheckQueueBounds(queue_to_free, *free_idx, &nb_queue_max);      
-                }  
-                // Remove the tile from the set
-                PopTileFromTileSet(&tile->tile_set->tiles, tile);
-                // Add the tile back to the illegal set
-                AddTileToTileSet(&illegal_set, tile);
-
-
-                cursor = cursor->next_set;
+                close(fd);
+                continue;
             }
-            tile = next_tile;
+            clients[nb_clients++] = (struct ServerClient_s){fd, 0, false, NULL, 0, 0, {0}};
         }
-        
-        FreeTileSets(table_sets);
-        // Check wich tiles can be added to the illegal set
-        table_sets = CopyTileSets(best->tile_set);
-        illegal_set = GetShortestNonValidSet(table_sets);
-        // Get tiles in table sets that can be added to the illegal set
-        struct Tile_s** set_to_add_left = wichTilesCanAddOnStart(illegal_set, table_sets);
-        
+    }
+    fprintf(stderr, "Error : server allocation failed\n");
+    close(listen_fd);
+    return EXIT_FAILURE;
+}
+
+// Phase of the generated games, the table is built with the melds found in the tiles drawn for it
+struct BenchPhase_s{
+    const char* name;
+    int nb_drawn_tiles;
+};
+
+static const struct BenchPhase_s bench_phases[] = {
+    {"early", 25},
+    {"mid", 55},
+    {"late", 85}
+};
+
+// Game state of the benchmark
+struct BenchState_s{
+    struct TileBitboard_s rack_tiles;
+    struct TableState_s table_state;
+};
+
+// Draw a rack and the tiles of the table from a new pile of the 104 tiles, the table keeps the melds that can be
+// made with its drawn tiles, taken in a random order. The states only depend on the generator seed
+void GenerateGameState(const struct Rummikub_s* solver, int nb_drawn_tiles, struct Random_s* random, struct BenchState_s* state)
+{
+    struct TilePool_s pool;
+    InitTilePool(&pool, random);
+    state->rack_tiles = DrawTilesFromPool(&pool, RACK_TILES);
+    struct TileBitboard_s drawn_tiles = DrawTilesFromPool(&pool, nb_drawn_tiles);
+
+    struct TileBitboard_s melds[NB_MELDS];
+    int nb_melds = GetRummikubMelds(solver, (struct TileBitboard_s){ALL_TILES_MASK, ALL_TILES_MASK}, melds);
+    for(int i = nb_melds - 1; i > 0; i--)
+    {
+        int j = GetRandomBelow(random, i + 1);
+        struct TileBitboard_s meld = melds[i];
+        melds[i] = melds[j];
+        melds[j] = meld;
+    }
+    InitTableState(&state->table_state);
+    for(int i = 0; i < nb_melds; i++)
+    {
+        struct TileBitboard_s meld_tiles = melds[i];
+        // A meld can be laid twice when both copies of its tiles were drawn
+        while(IsBitboardSubsetOf(meld_tiles, drawn_tiles) && AddSetToTableState(&state->table_state, meld_tiles))
+            drawn_tiles = BitboardDifference(drawn_tiles, meld_tiles);
+    }
+}
+
+// Return the peak resident memory of the process in kilobytes
+long GetPeakMemory()
+{
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage))
+        return -1;
+    return usage.ru_maxrss;
+}
+
+// Solvers run by the benchmark
+enum BenchSolver_e{
+    BENCH_COMBINATIONS,     // Best melds made with the rack alone
+    BENCH_ASTAR,
+    BENCH_DP,
+    NB_BENCH_SOLVERS
+};
+
+static const char* bench_solver_names[NB_BENCH_SOLVERS] = {"combinations", "astar", "dp"};
+
+// Solve a benchmark state, return the number of tiles placed
+static int RunBenchSolver(enum BenchSolver_e bench_solver, struct Rummikub_s* solver, const struct BenchState_s* state, unsigned long* nb_nodes)
+{
+    if(bench_solver == BENCH_COMBINATIONS)
+    {
+        struct TableState_s best_sets;
+        SolveRummikubRack(solver, state->rack_tiles, &best_sets, nb_nodes);
+        return GetBitboardTilesNumber(GetTableStateTiles(&best_sets));
+    }
+    struct Placement_s placement;
+    if(SolveRummikub(solver, state->rack_tiles, &state->table_state, &placement))
+        return 0;
+#ifdef RUMMIKUB_STATS
+    PrintSearchStats(stderr, bench_solver_names[bench_solver], &placement.stats);
+#endif
+    *nb_nodes = placement.stats.nb_nodes;
+    return placement.nb_placed_tiles;
+}
 
-        int idx = 0;
-        while(set_to_add_left[idx])
+// Run every solver over nb_states seeded game states of each phase and print the results as JSON
+int RunBenchmark(unsigned int seed, int nb_states, const struct SolverOptions_s* options)
+{
+    // One handle per engine, the rack melds are searched with the A* handle
+    struct Rummikub_s* solvers[NB_BENCH_SOLVERS] = {NULL};
+    const char* error = NULL;
+    struct SolverOptions_s engine_options = *options;
+    engine_options.engine = ENGINE_ASTAR;
+    solvers[BENCH_ASTAR] = solvers[BENCH_COMBINATIONS] = CreateRummikub(&engine_options, &error);
+    engine_options.engine = ENGINE_DP;
+    if(solvers[BENCH_ASTAR])
+        solvers[BENCH_DP] = CreateRummikub(&engine_options, &error);
+    struct BenchState_s* states = malloc(sizeof(struct BenchState_s) * nb_states);
+    if(!states || !solvers[BENCH_DP])
+    {
+        fprintf(stderr, "Error : %s\n", error ? error : "benchmark allocation failed");
+        FreeRummikub(solvers[BENCH_ASTAR]);
+        FreeRummikub(solvers[BENCH_DP]);
+        free(states);
+        return EXIT_FAILURE;
+    }
+    struct Random_s random;
+    SeedRandom(&random, seed);
+    printf("{\"seed\":%u,\"states\":%d,\"threads\":%d,\"heuristic\":\"%s\",\"search\":\"%s\",\"depth\":%d,\"run_table\":%s,\"results\":[\n", seed, nb_states, options->nb_threads,
+           GetHeuristicName(options->heuristic), options->iterative_deepening ? "ida" : "astar", options->max_depth, options->run_table_path ? "true" : "false");
+    int nb_phases = sizeof(bench_phases) / sizeof(bench_phases[0]);
+    for(int phase = 0; phase < nb_phases; phase++)
+    {
+        long table_tiles = 0;
+        for(int i = 0; i < nb_states; i++)
         {
-            // Remove the tile from where it was and add it at the start of the illegal set
-            PopTileFromTileSet(&set_to_add_left[idx]->tile_set->tiles, set_to_add_left[idx]);
-            struct TileSet_s* previous_tileset = set_to_add_left[idx]->tile_set;
-            AddTileToTileSet(&illegal_set, set_to_add_left[idx]);
-
-            // Add the new table states to the priority queue
-            struct PriorityQueue_s* new_queue = CreatePriorityQueue(table_sets, best, best->g + 1);
-            AddToPriorityQueue(&queue, new_queue); 
-            (*queue_to_free)[(*free_idx)++] = new_queue;  
-            CheckQueueBounds(queue_to_free, *free_idx, &nb_queue_max);       
-
-            // Put back the tile in the table sets
-            PopTileFromTileSet(&set_to_add_left[idx]->tile_set->tiles, set_to_add_left[idx]);
-            AddTileToSortedTileSet(&previous_tileset, set_to_add_left[idx]);
-            
-            idx++;
+            GenerateGameState(solvers[BENCH_ASTAR], bench_phases[phase].nb_drawn_tiles, &random, &states[i]);
+            table_tiles += GetBitboardTilesNumber(GetTableStateTiles(&states[i].table_state));
         }
-        FreeTileSets(table_sets);
-        free(set_to_add_left);
-        
-        table_sets = CopyTileSets(best->tile_set);
-        illegal_set = GetShortestNonValidSet(table_sets);
-        struct Tile_s** set_to_add_right = wichTilesCanAddOnEnd(illegal_set, table_sets);
-        idx = 0;
-        while(set_to_add_right[idx])
+        for(int bench_solver = 0; bench_solver < NB_BENCH_SOLVERS; bench_solver++)
         {
-            // Remove the tile from where it was and add it at the start of the illegal set
-            PopTileFromTileSet(&set_to_add_right[idx]->tile_set->tiles, set_to_add_right[idx]);
-            struct TileSet_s* previous_tileset = set_to_add_right[idx]->tile_set;
-            PutTileAtEndOfTileSet(illegal_set, set_to_add_right[idx]);
-            // Add the new table states to the priority queue
-            struct PriorityQueue_s* new_queue = CreatePriorityQueue(table_sets, best, best->g + 1);
-            AddToPriorityQueue(&queue, new_queue);   
-            (*queue_to_free)[(*free_idx)++] = new_queue;   
-            CheckQueueBounds(queue_to_free, *free_idx, &nb_queue_max);       
-            // Put back the tile in the table sets
-            PopTileFromTileSet(&set_to_add_right[idx]->tile_set->tiles, set_to_add_right[idx]);
-            AddTileToSortedTileSet(&previous_tileset, set_to_add_right[idx]);
-            idx++;
+            unsigned long nb_nodes = 0;
+            int nb_solved = 0;
+            long nb_placed_tiles = 0;
+            struct timespec start;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for(int i = 0; i < nb_states; i++)
+            {
+                unsigned long state_nodes = 0;
+                int state_tiles = RunBenchSolver(bench_solver, solvers[bench_solver], &states[i], &state_nodes);
+                if(state_tiles > 0)
+                    nb_solved++;
+                nb_placed_tiles += state_tiles;
+                nb_nodes += state_nodes;
+            }
+            double wall_us = GetElapsedMicroseconds(&start);
+            bool last = phase == nb_phases - 1 && bench_solver == NB_BENCH_SOLVERS - 1;
+            printf("{\"phase\":\"%s\",\"solver\":\"%s\",\"table_tiles\":%.1f,\"wall_ms\":%.3f,\"mean_us\":%.1f,"
+                   "\"nodes\":%lu,\"solved\":%d,\"solve_rate\":%.3f,\"placed_tiles\":%ld}%s\n",
+                   bench_phases[phase].name, bench_solver_names[bench_solver], (double)table_tiles / nb_states,
+                   wall_us / 1e3, wall_us / nb_states, nb_nodes, nb_solved,
+                   (double)nb_solved / nb_states, nb_placed_tiles, last ? "" : ",");
+            fflush(stdout);
         }
-        FreeTileSets(table_sets);
-        free(set_to_add_right);
+    }
+    // The peak memory of the process only grows, it is the peak of the whole run rather than of a solver
+    printf("],\"peak_rss_kb\":%ld}\n", GetPeakMemory());
+    free(states);
+    FreeRummikub(solvers[BENCH_ASTAR]);
+    FreeRummikub(solvers[BENCH_DP]);
+    return EXIT_SUCCESS;
+}
+
+// Counters of a seat over the simulated games
+struct SeatStats_s{
+    unsigned long nb_wins;
+    unsigned long nb_turns;
+    unsigned long nb_placed_tiles;
+    unsigned long nb_errors;    // Solves failing or returning a placement breaking the rules
+    unsigned long nb_solves;
+    double latency_us;          // Total time of the solves
+    uint64_t max_latency_ns;
+    unsigned long latencies[LATENCY_BUCKETS];   // Histogram of the solve times in nanoseconds
+};
 
-        table_sets = CopyTileSets(best->tile_set);
-        illegal_set = GetShortestNonValidSet(table_sets);
-        //If the illegal set contains 2 tiles, split it in 2 sets
-        if(illegal_set->number == 2)
-        {
-            struct TileSet_s* new_set = CreateTilesSet();
-            // Pop the first tile from the illegal set
-            struct Tile_s *tile = illegal_set->tiles;
-            PopTileFromTileSet(&tile->tile_set->tiles, tile);
-            // Add the first tile to the new set
-            AddTileToTileSet(&new_set, tile);
-            // Add the new set to the table sets
-            AddTileSetToTileSet(&table_sets, new_set);
-            struct PriorityQueue_s* new_queue = CreatePriorityQueue(table_sets, best, best->g + 2);
-            AddToPriorityQueue(&queue, new_queue);   
-            (*queue_to_free)[(*free_idx)++] = new_queue;   
-            CheckQueueBounds(queue_to_free, *free_idx, &nb_queue_max); 
-        }
-        FreeTileSets(table_sets);
-        
-    } 
-    printf("No solution found\n");
-}
+// Games played by the simulator, the game of index i only depends on the seed and i : its generator is seeded with both
+struct Simulation_s{
+    unsigned int seed;
+    unsigned long nb_games;
+    unsigned long next_game;    // Next game taken by a thread
+    int nb_players;
+    enum SolverEngine_e seats[MAX_GAME_PLAYERS];
+};
 
-void FreePriorityQueueNode(struct PriorityQueue_s* queue)
+// Thread of the simulator with its solver handles, one per engine, and the counters of the games it played
+struct SimWorker_s{
+    pthread_t thread;
+    struct Simulation_s* simulation;
+    struct Rummikub_s* solvers[ENGINE_DP + 1];
+    unsigned long nb_games;
+    unsigned long nb_blocked;   // Games ended with an empty pool and a round without tile placed
+    struct SeatStats_s seats[MAX_GAME_PLAYERS];
+};
+
+// Return the histogram bucket of a latency : the 2 bits following the leading bit split each power of 2 in 4
+static int GetLatencyBucket(uint64_t latency_ns)
 {
-    FreeTileSets(queue->tile_set);
-    free(queue);
+    if(latency_ns < 4)
+        return latency_ns;
+    int exponent = 63 - __builtin_clzll(latency_ns);
+    return 4 + (exponent - 2) * 4 + (int)(latency_ns >> (exponent - 2)) - 4;
 }
 
-void ShowSteps(struct PriorityQueue_s* queue)
+// Return the upper bound of the latencies of a histogram bucket
+static uint64_t GetLatencyBucketLimit(int bucket)
 {
-    if(!queue)
-        return;
-    ShowSteps(queue->previous_set);
-    PrintTileSets(queue->tile_set);
-    FreePriorityQueueNode(queue);
+    if(bucket < 4)
+        return bucket + 1;
+    int exponent = (bucket - 4) / 4 + 2;
+    return (uint64_t)(4 + (bucket - 4) % 4 + 1) << (exponent - 2);
 }
 
-void FreePriorityQueue(struct PriorityQueue_s* queue)
+// Return the latency in microseconds under which the fraction of the solves of a seat ran, rounded up to its bucket
+static double GetLatencyQuantile(const struct SeatStats_s* seat, double fraction)
 {
-    while(queue)
+    unsigned long rank = fraction * seat->nb_solves;
+    unsigned long count = 0;
+    for(int bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
     {
-        struct PriorityQueue_s* next = queue->next_set;
-        FreePriorityQueueNode(queue);
-        queue = next;
+        count += seat->latencies[bucket];
+        if(count > rank)
+        {
+            uint64_t limit = GetLatencyBucketLimit(bucket);
+            return (limit < seat->max_latency_ns ? limit : seat->max_latency_ns) / 1e3;
+        }
     }
+    return seat->max_latency_ns / 1e3;
 }
 
-// Copy a priority queue list
-struct PriorityQueue_s* CopyPriorityQueues(struct PriorityQueue_s* queue)
+// Play the turn of a player : the first melds are laid from the rack alone once they score INITIAL_MELD_SCORE, the
+// next turns place rack tiles on the table with the engine of the seat. Return the number of tiles placed
+static int PlaySimulatedTurn(struct SimWorker_s* worker, int player, struct TileBitboard_s* rack, bool* opened, struct TableState_s* table_state)
 {
-    if(!queue->previous_set)
-    {
-        return CreatePriorityQueue(queue->tile_set, NULL, queue->g);
+    struct SeatStats_s* seat = &worker->seats[player];
+    struct Rummikub_s* solver = worker->solvers[worker->simulation->seats[player]];
+    if(!*opened)
+    {
+        struct TableState_s melds;
+        if(SolveRummikubRack(solver, *rack, &melds, NULL) < INITIAL_MELD_SCORE || table_state->nb_sets + melds.nb_sets > MAX_TABLE_SETS)
+            return 0;
+        for(int i = 0; i < melds.nb_sets; i++)
+            AddSetToTableState(table_state, melds.sets[i]);
+        struct TileBitboard_s tiles = GetTableStateTiles(&melds);
+        *rack = BitboardDifference(*rack, tiles);
+        *opened = true;
+        return GetBitboardTilesNumber(tiles);
+    }
+
+    struct Placement_s placement;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    const char* error = SolveRummikub(solver, *rack, table_state, &placement);
+    double latency_us = GetElapsedMicroseconds(&start);
+    uint64_t latency_ns = latency_us * 1e3;
+    seat->nb_solves++;
+    seat->latency_us += latency_us;
+    seat->latencies[GetLatencyBucket(latency_ns)]++;
+    if(latency_ns > seat->max_latency_ns)
+        seat->max_latency_ns = latency_ns;
+
+    // The placement must keep the table tiles, take the others from the rack and leave valid melds
+    struct TileBitboard_s table_tiles = GetTableStateTiles(table_state);
+    if(error || !IsBitboardSubsetOf(placement.placed_tiles, *rack) || !IsBitboardSubsetOf(table_tiles, GetTableStateTiles(&placement.table_state))
+       || GetBitboardTilesNumber(table_tiles) + placement.nb_placed_tiles != GetBitboardTilesNumber(GetTableStateTiles(&placement.table_state))
+       || !AreValidTableSets(&placement.table_state))
+    {
+        seat->nb_errors++;
+        return 0;
+    }
+    if(!placement.nb_placed_tiles)
+        return 0;
+    *table_state = placement.table_state;
+    *rack = BitboardDifference(*rack, placement.placed_tiles);
+    return placement.nb_placed_tiles;
+}
+
+// Play a game until a rack is empty, or until the pool is empty and no player placed a tile for a round : the
+// player with the lowest rack score wins then. The first player changes with the game index
+static void PlaySimulatedGame(struct SimWorker_s* worker, unsigned long game_index)
+{
+    const struct Simulation_s* simulation = worker->simulation;
+    int nb_players = simulation->nb_players;
+    struct Random_s random;
+    SeedRandom(&random, (uint64_t)simulation->seed << 32 | (uint32_t)game_index);
+    struct TilePool_s pool;
+    InitTilePool(&pool, &random);
+    struct TileBitboard_s racks[MAX_GAME_PLAYERS];
+    bool opened[MAX_GAME_PLAYERS] = {false};
+    for(int player = 0; player < nb_players; player++)
+        racks[player] = DrawTilesFromPool(&pool, RACK_TILES);
+    struct TableState_s table_state;
+    InitTableState(&table_state);
+
+    int player = game_index % nb_players;
+    int nb_passes = 0;
+    int winner = -1;
+    while(winner < 0)
+    {
+        struct SeatStats_s* seat = &worker->seats[player];
+        seat->nb_turns++;
+        int nb_placed_tiles = PlaySimulatedTurn(worker, player, &racks[player], &opened[player], &table_state);
+        seat->nb_placed_tiles += nb_placed_tiles;
+        if(!GetBitboardTilesNumber(racks[player]))
+            winner = player;
+        else if(nb_placed_tiles)
+            nb_passes = 0;
+        else if(pool.nb_tiles > 0)
+            AddTileIdToBitboard(&racks[player], DrawTileFromPool(&pool));
+        else if(++nb_passes == nb_players)
+        {
+            winner = 0;
+            for(int i = 1; i < nb_players; i++)
+                if(GetBitboardScore(racks[i]) < GetBitboardScore(racks[winner]))
+                    winner = i;
+            worker->nb_blocked++;
+        }
+        player = (player + 1) % nb_players;
     }
+    worker->seats[winner].nb_wins++;
+    worker->nb_games++;
+}
 
-    struct PriorityQueue_s* new_queue = CreatePriorityQueue(queue->tile_set, CopyPriorityQueues(queue->previous_set), queue->g);
-    return new_queue;
+static void* SimulatorThread(void* argument)
+{
+    struct SimWorker_s* worker = argument;
+    struct Simulation_s* simulation = worker->simulation;
+    unsigned long game_index;
+    while((game_index = __atomic_fetch_add(&simulation->next_game, 1, __ATOMIC_RELAXED)) < simulation->nb_games)
+        PlaySimulatedGame(worker, game_index);
+    return NULL;
 }
 
-struct PriorityQueue_s* CopyPriorityQueue(struct PriorityQueue_s* queue)
+// Parse the engines of the seats separated by commas, "astar,dp", return the number of seats or 0 if invalid
+int GetSeatsFromString(const char* string, enum SolverEngine_e* seats)
 {
-    struct PriorityQueue_s* new_queue = CreatePriorityQueue(queue->tile_set, NULL, queue->g);
-    return new_queue;
+    int nb_seats = 0;
+    while(*string)
+    {
+        size_t length = strcspn(string, ",");
+        if(nb_seats == MAX_GAME_PLAYERS)
+            return 0;
+        if(length == 5 && !strncmp(string, "astar", 5))
+            seats[nb_seats++] = ENGINE_ASTAR;
+        else if(length == 2 && !strncmp(string, "dp", 2))
+            seats[nb_seats++] = ENGINE_DP;
+        else
+            return 0;
+        string += length;
+        if(*string == ',')
+            string++;
+    }
+    return nb_seats >= 2 ? nb_seats : 0;
 }
 
-void AStar(const struct TileSet_s* restrict player_tileset, const struct TileSet_s* restrict table_tileset)
+// Play nb_games seeded games between the seats on one thread per options->nb_threads, every thread solves with its
+// own single threaded handles. Print the games per second, the wins and the solve latencies of each seat as JSON
+int RunSimulator(unsigned int seed, unsigned long nb_games, const enum SolverEngine_e* seats, int nb_players, const struct SolverOptions_s* options)
 {
-    /*struct PriorityQueue_s* resolved_set;
-    struct TileSet_s* copy_table_tileset;
-    struct TileSet_s* copy_player_tileset = CopyTileSets(player_tileset);
-    struct Tile_s* player_tile = copy_player_tileset->tiles;
-    // Try to add every tile on the rack to the table
-    while(player_tile)
+    struct Simulation_s simulation = {seed, nb_games, 0, nb_players, {0}};
+    for(int player = 0; player < nb_players; player++)
+        simulation.seats[player] = seats[player];
+    int nb_workers = options->nb_threads;
+    if((unsigned long)nb_workers > nb_games)
+        nb_workers = nb_games;
+    struct SimWorker_s* workers = calloc(nb_workers, sizeof(struct SimWorker_s));
+    if(!workers)
+    {
+        fprintf(stderr, "Error : simulator allocation failed\n");
+        return EXIT_FAILURE;
+    }
+    struct SolverOptions_s engine_options = *options;
+    engine_options.nb_threads = 1;
+    const char* error = NULL;
+    for(int i = 0; i < nb_workers && !error; i++)
+    {
+        workers[i].simulation = &simulation;
+        for(int player = 0; player < nb_players && !error; player++)
+        {
+            enum SolverEngine_e engine = seats[player];
+            engine_options.engine = engine;
+            if(!workers[i].solvers[engine] && !(workers[i].solvers[engine] = CreateRummikub(&engine_options, &error)))
+                break;
+        }
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    // The calling thread plays the games of the first worker, fewer threads play when one cannot be started
+    int nb_started = 1;
+    while(!error && nb_started < nb_workers && !pthread_create(&workers[nb_started].thread, NULL, SimulatorThread, &workers[nb_started]))
+        nb_started++;
+    if(!error)
+        SimulatorThread(&workers[0]);
+    for(int i = 1; !error && i < nb_started; i++)
+        pthread_join(workers[i].thread, NULL);
+    double wall_us = GetElapsedMicroseconds(&start);
+
+    struct SeatStats_s total[MAX_GAME_PLAYERS] = {0};
+    unsigned long nb_blocked = 0;
+    for(int i = 0; i < nb_workers; i++)
+    {
+        nb_blocked += workers[i].nb_blocked;
+        for(int player = 0; player < nb_players; player++)
+        {
+            const struct SeatStats_s* seat = &workers[i].seats[player];
+            total[player].nb_wins += seat->nb_wins;
+            total[player].nb_turns += seat->nb_turns;
+            total[player].nb_placed_tiles += seat->nb_placed_tiles;
+            total[player].nb_errors += seat->nb_errors;
+            total[player].nb_solves += seat->nb_solves;
+            total[player].latency_us += seat->latency_us;
+            if(seat->max_latency_ns > total[player].max_latency_ns)
+                total[player].max_latency_ns = seat->max_latency_ns;
+            for(int bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+                total[player].latencies[bucket] += seat->latencies[bucket];
+        }
+        for(int engine = 0; engine <= ENGINE_DP; engine++)
+            FreeRummikub(workers[i].solvers[engine]);
+    }
+    free(workers);
+    if(error)
     {
-        struct Tile_s* next_tile = player_tile->next_tile;
-        copy_table_tileset = CopyTileSets(table_tileset);
-        AddTileSetToTileSet(&copy_table_tileset, CreateTilesSet());
-        PopTileFromTileSet(&player_tile->tile_set->tiles, player_tile);
-        AddTileToTileSet(&copy_table_tileset, player_tile);
-        struct PriorityQueue_s* queue = CreatePriorityQueue(copy_table_tileset, NULL, 0);
-        struct PriorityQueue_s** queue_to_free = malloc(sizeof(struct PriorityQueue_s*) * 100);
-        int nb_free = 0;
-        resolved_set = ResolvedTileset(copy_table_tileset, queue, &queue_to_free, &nb_free);
-        if(resolved_set)
+        fprintf(stderr, "Error : %s\n", error);
+        return EXIT_FAILURE;
+    }
+
+    unsigned long nb_turns = 0;
+    for(int player = 0; player < nb_players; player++)
+        nb_turns += total[player].nb_turns;
+    printf("{\"seed\":%u,\"games\":%lu,\"players\":%d,\"threads\":%d,\"heuristic\":\"%s\",\"search\":\"%s\",\"depth\":%d,\"run_table\":%s,"
+           "\"wall_ms\":%.3f,\"games_per_s\":%.1f,\"turns_per_game\":%.1f,\"blocked\":%lu,\"seats\":[\n",
+           seed, nb_games, nb_players, nb_started, GetHeuristicName(options->heuristic), options->iterative_deepening ? "ida" : "astar",
+           options->max_depth, options->run_table_path ? "true" : "false", wall_us / 1e3, nb_games / (wall_us / 1e6),
+           (double)nb_turns / nb_games, nb_blocked);
+    for(int player = 0; player < nb_players; player++)
+    {
+        const struct SeatStats_s* seat = &total[player];
+        printf("{\"seat\":%d,\"engine\":\"%s\",\"wins\":%lu,\"win_rate\":%.3f,\"turns\":%lu,\"placed_tiles\":%lu,\"errors\":%lu,"
+               "\"solves\":%lu,\"mean_us\":%.1f,\"p50_us\":%.1f,\"p90_us\":%.1f,\"p99_us\":%.1f,\"p999_us\":%.1f,\"max_us\":%.1f}%s\n",
+               player, seats[player] == ENGINE_DP ? "dp" : "astar", seat->nb_wins, (double)seat->nb_wins / nb_games, seat->nb_turns,
+               seat->nb_placed_tiles, seat->nb_errors, seat->nb_solves, seat->nb_solves ? seat->latency_us / seat->nb_solves : 0,
+               GetLatencyQuantile(seat, 0.5), GetLatencyQuantile(seat, 0.9), GetLatencyQuantile(seat, 0.99),
+               GetLatencyQuantile(seat, 0.999), seat->max_latency_ns / 1e3, player == nb_players - 1 ? "" : ",");
+    }
+    printf("]}\n");
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char** argv) {
+    struct SolverOptions_s options = {ENGINE_ASTAR, GetDefaultThreadCount(), DeficitHeuristic, MAX_RESOLVE_DEPTH, false, 0, NULL, NULL, 0, false, OBJECTIVE_TILES};
+    const char* cache_path = NULL;
+    size_t cache_mb = DEFAULT_SOLVE_CACHE_MB;
+    bool cache_read_only = false;
+    const char* run_table_path = NULL;
+    bool batch = false;
+    bool binary = false;
+    bool encode = false;
+    bool decode = false;
+    const char* input_path = NULL;
+    bool server = false;
+    const char* socket_path = NULL;
+    bool bench = false;
+    unsigned int bench_seed = 1;
+    int bench_states = 50;
+    bool simulate = false;
+    unsigned long nb_games = 1000;
+    enum SolverEngine_e seats[MAX_GAME_PLAYERS] = {ENGINE_ASTAR, ENGINE_ASTAR};
+    int nb_players = 2;
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "--batch") || !strcmp(argv[i], "--encode") || !strcmp(argv[i], "--decode"))
         {
-            PopTileFromTileSet(&player_tile->tile_set->tiles, player_tile);
-            AddTileToTileSet(&player_tile->tile_set, player_tile);
-            printf("Solution Found :\n");
-            PrintTileSets(resolved_set->tile_set);
-            printf("Steps :\n");
-            ShowSteps(resolved_set);
-            FreePriorityQueueNode(queue);
-            for (int i = 0; i < nb_free; i++)
-                FreePriorityQueueNode(queue_to_free[i]);
-            free(queue_to_free);
-            FreeTileSets(copy_table_tileset);
-            break;
+            batch |= !strcmp(argv[i], "--batch");
+            encode |= !strcmp(argv[i], "--encode");
+            decode |= !strcmp(argv[i], "--decode");
+            // The states are read from stdin when no file follows
+            if(i + 1 < argc && strncmp(argv[i + 1], "--", 2))
+                input_path = argv[++i];
+            continue;
         }
-        PopTileFromTileSet(&player_tile->tile_set->tiles, player_tile);
-        AddTileToTileSet(&player_tile->tile_set, player_tile);
-        FreePriorityQueueNode(queue);
-        for (int i = 0; i < nb_free; i++)
-            FreePriorityQueueNode(queue_to_free[i]);
-        free(queue_to_free);
-        
-        FreeTileSets(copy_table_tileset);
-        player_tile = next_tile;
-    }
-    FreeTileSets(copy_player_tileset);
-    */
-
-    struct PriorityQueue_s* current_queue = CreatePriorityQueue(table_tileset, NULL, 0);
-    struct PriorityQueue_s* next_queue = NULL;
-    struct PriorityQueue_s* possible_moves = NULL;
-
-    struct TileSet_s* copy_table_tilesets;
-    struct TileSet_s* copy_player_tileset;
-     struct TileSet_s* tileset;
-    while(current_queue)
-    {
-        copy_table_tilesets = CopyTileSets(current_queue->tile_set);
-        copy_player_tileset = CopyTileSets(player_tileset);
-        tileset = copy_table_tilesets;
-        struct TileSet_s* next_tileset;
-        while(tileset)
+        if(!strcmp(argv[i], "--server"))
         {
-            next_tileset = tileset->next_set;
-            struct Tile_s* player_tile = copy_player_tileset->tiles;
-            while(player_tile)
+            server = true;
+            // The requests are read from stdin when no socket follows
+            if(i + 1 < argc && strncmp(argv[i + 1], "--", 2))
+                socket_path = argv[++i];
+            continue;
+        }
+        if(!strcmp(argv[i], "--bench"))
+            bench = true;
+        else if(!strcmp(argv[i], "--binary"))
+            binary = true;
+        else if(!strcmp(argv[i], "--simulate"))
+            simulate = true;
+        else if(!strcmp(argv[i], "--games") && i + 1 < argc)
+        {
+            nb_games = strtoul(argv[++i], NULL, 10);
+            if(!nb_games)
             {
-                //struct Tile_s* next_tile = player_tile->next_tile;
-                AddTileSetToTileSet(&tileset, CreateTilesSet());
-                AddTileToTileSet(&tileset, CreateTile(player_tile->number, player_tile->color));
-                struct PriorityQueue_s* queue = CreatePriorityQueue(tileset, NULL, 0);
-                struct PriorityQueue_s** queue_to_free = malloc(sizeof(struct PriorityQueue_s*) * 100);
-                int nb_free = 0;
-                struct PriorityQueue_s* resolved_set = ResolvedTileset(tileset, queue, &queue_to_free, &nb_free);
-                
-                if(resolved_set){
-                    AddToPriorityQueue(&possible_moves, CopyPriorityQueues(resolved_set));
-                    AddToPriorityQueue(&next_queue, CopyPriorityQueue(resolved_set));
-                }
-
-                for (int i = 0; i < nb_free; i++)
-                    if(queue_to_free[i])
-                        FreePriorityQueueNode(queue_to_free[i]);
-                free(queue_to_free);
-                FreePriorityQueueNode(queue);
-                player_tile = player_tile->next_tile;
+                printf("Error : the number of games must be positive\n");
+                return EXIT_FAILURE;
             }
-            //FreeTileSets(tileset);
-            tileset = next_tileset;
-
         }
-        FreeTileSets(copy_table_tilesets);
-        FreeTileSets(copy_player_tileset);
-        struct PriorityQueue_s* cursor = current_queue;
-        while(cursor)
+        else if(!strcmp(argv[i], "--seats") && i + 1 < argc)
         {
-            struct PriorityQueue_s* next_cursor = cursor->next_set;
-            FreePriorityQueueNode(cursor);
-            cursor = next_cursor;
+            nb_players = GetSeatsFromString(argv[++i], seats);
+            if(!nb_players)
+            {
+                printf("Error : the seats must be 2 to %d engines separated by commas (astar or dp)\n", MAX_GAME_PLAYERS);
+                return EXIT_FAILURE;
+            }
+        }
+        else if(!strcmp(argv[i], "--seed") && i + 1 < argc)
+            bench_seed = strtoul(argv[++i], NULL, 10);
+        else if(!strcmp(argv[i], "--states") && i + 1 < argc)
+        {
+            bench_states = atoi(argv[++i]);
+            if(bench_states < 1)
+            {
+                printf("Error : the number of states must be positive\n");
+                return EXIT_FAILURE;
+            }
+        }
+        else if(!strcmp(argv[i], "--engine") && i + 1 < argc)
+        {
+            i++;
+            if(!strcmp(argv[i], "dp"))
+                options.engine = ENGINE_DP;
+            else if(!strcmp(argv[i], "astar"))
+                options.engine = ENGINE_ASTAR;
+            else
+            {
+                printf("Error : unknown engine %s (astar or dp)\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if(!strcmp(argv[i], "--objective") && i + 1 < argc)
+        {
+            i++;
+            if(!strcmp(argv[i], "tiles"))
+                options.objective = OBJECTIVE_TILES;
+            else if(!strcmp(argv[i], "score"))
+                options.objective = OBJECTIVE_SCORE;
+            else
+            {
+                printf("Error : unknown objective %s (tiles or score)\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if(!strcmp(argv[i], "--heuristic") && i + 1 < argc)
+        {
+            options.heuristic = GetHeuristicFromName(argv[++i]);
+            if(!options.heuristic)
+            {
+                printf("Error : unknown heuristic %s (partial, illegal or deficit)\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if(!strcmp(argv[i], "--cache") && i + 1 < argc)
+            cache_path = argv[++i];
+        else if(!strcmp(argv[i], "--cache-size") && i + 1 < argc)
+        {
+            cache_mb = strtoul(argv[++i], NULL, 10);
+            if(!cache_mb)
+            {
+                printf("Error : the cache size must be a positive number of MB\n");
+                return EXIT_FAILURE;
+            }
+        }
+        else if(!strcmp(argv[i], "--cache-readonly"))
+            cache_read_only = true;
+        else if(!strcmp(argv[i], "--generate-run-table"))
+        {
+            const char* path = i + 1 < argc && strncmp(argv[i + 1], "--", 2) ? argv[++i] : DEFAULT_RUN_TABLE_FILE;
+            if(!WriteRunTable(path))
+            {
+                fprintf(stderr, "Error : cannot write the run table %s\n", path);
+                return EXIT_FAILURE;
+            }
+            return EXIT_SUCCESS;
+        }
+        else if(!strcmp(argv[i], "--run-table") && i + 1 < argc)
+            run_table_path = argv[++i];
+        else if(!strcmp(argv[i], "--deadline") && i + 1 < argc)
+        {
+            options.deadline_ms = atof(argv[++i]);
+            if(options.deadline_ms <= 0)
+            {
+                printf("Error : the deadline must be a positive number of milliseconds\n");
+                return EXIT_FAILURE;
+            }
+        }
+        else if(!strcmp(argv[i], "--ida"))
+            options.iterative_deepening = true;
+        else if(!strcmp(argv[i], "--depth") && i + 1 < argc)
+        {
+            options.max_depth = atoi(argv[++i]);
+            if(options.max_depth < 0 || options.max_depth > MAX_SEARCH_DEPTH)
+            {
+                printf("Error : the search depth must be between 0 and %d\n", MAX_SEARCH_DEPTH);
+                return EXIT_FAILURE;
+            }
+        }
+        else if(!strcmp(argv[i], "--threads") && i + 1 < argc)
+        {
+            options.nb_threads = atoi(argv[++i]);
+            if(options.nb_threads < 1 || options.nb_threads > MAX_SOLVER_THREADS)
+            {
+                printf("Error : the number of threads must be between 1 and %d\n", MAX_SOLVER_THREADS);
+                return EXIT_FAILURE;
+            }
         }
-        current_queue = next_queue;
-        next_queue = NULL;
+    }
+    // The run table is optional, the default file is only used when it exists
+    options.run_table_path = run_table_path;
+    if(!run_table_path && !access(DEFAULT_RUN_TABLE_FILE, R_OK))
+        options.run_table_path = DEFAULT_RUN_TABLE_FILE;
+    if(bench)
+        return RunBenchmark(bench_seed, bench_states, &options);
+    if(simulate)
+        return RunSimulator(bench_seed, nb_games, seats, nb_players, &options);
+    if(!batch && !server && !encode && !decode)
+    {
+        printf("Rummikub Solver\n");
+        return MainLoop(options);
     }
 
-    // Check among all possible moves
-    struct PriorityQueue_s* cursor = possible_moves;
-    while(cursor)
+    FILE* input = stdin;
+    if(input_path && !(input = fopen(input_path, "r")))
+    {
+        fprintf(stderr, "Error : cannot open %s\n", input_path);
+        return EXIT_FAILURE;
+    }
+    if(encode || decode)
     {
-        printf("Possible Move :\n");
-        struct PriorityQueue_s* next_cursor = cursor->next_set;
-        PrintTileSets(cursor->tile_set);
-        printf("Steps :\n");
-        ShowSteps(cursor);
-        cursor = next_cursor;
+        int status = encode ? EncodeGameStates(input, stdout) : DecodeGameStates(input, stdout);
+        if(input != stdin)
+            fclose(input);
+        return status;
     }
+    // The results of the game states are kept in the cache file between runs, the handle is created once for all
+    // the game states
+    options.cache_path = cache_path;
+    options.cache_bytes = cache_mb << 20;
+    options.cache_read_only = cache_read_only;
+    const char* error;
+    struct Rummikub_s* solver = CreateRummikub(&options, &error);
+    if(!solver)
+    {
+        fprintf(stderr, "Error : %s\n", error);
+        return EXIT_FAILURE;
+    }
+    int status = server && socket_path ? RunServer(socket_path, solver) : binary ? RunBinaryBatch(input, solver) : RunBatch(input, solver);
+    if(input != stdin)
+        fclose(input);
+    FreeRummikub(solver);
+    return status;
 }
 
-int main(int argc, char** argv) {
-    printf("Rummikub Solver\n");
-    srand(time(NULL));
-    MainLoop();
+// Free lists of the released tiles and sets, they are allocated by chunks and reused by CreateTile and CreateTilesSet
+static struct Tile_s* free_tiles = NULL;
+static struct TileSet_s* free_tilesets = NULL;
+
+static void FillTilePool()
+{
+    struct Tile_s* tiles = malloc(sizeof(struct Tile_s) * POOL_CHUNK_SIZE);
+    if(!tiles)
+    {
+        printf("Error: tile pool allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for(int i = 0; i < POOL_CHUNK_SIZE; i++)
+        ReleaseTile(&tiles[i]);
 }
 
+static void FillTileSetPool()
+{
+    struct TileSet_s* tilesets = malloc(sizeof(struct TileSet_s) * POOL_CHUNK_SIZE);
+    if(!tilesets)
+    {
+        printf("Error: tile set pool allocation failed\n");
+        exit(EXIT_FAILURE);
+    }
+    for(int i = 0; i < POOL_CHUNK_SIZE; i++)
+        ReleaseTileSet(&tilesets[i]);
+}
 
+// Give back a tile to the pool
+void ReleaseTile(struct Tile_s* tile)
+{
+    tile->next_tile = free_tiles;
+    free_tiles = tile;
+}
 
-// Return a tile allocated on the heap with number and color field
+// Give back a tile set to the pool, its tiles are not released
+void ReleaseTileSet(struct TileSet_s* tileset)
+{
+    tileset->next_set = free_tilesets;
+    free_tilesets = tileset;
+}
+
+// Return a tile taken from the pool with number and color field
 struct Tile_s* CreateTile(int number, char color)
 {
-    struct Tile_s* tile = malloc(sizeof(struct Tile_s));
+    if(!free_tiles)
+        FillTilePool();
+    struct Tile_s* tile = free_tiles;
+    free_tiles = tile->next_tile;
     *tile = (struct Tile_s){number, color, NULL, NULL, NULL};
     return tile;
 }
@@ -1654,8 +2264,11 @@ struct Tile_s* CreateTile(int number, char color)
 // Create tile set with 0 tiles, size 0 and next set NULL
 struct TileSet_s* CreateTilesSet()
 {
-    struct TileSet_s* tileset = malloc(sizeof(struct TileSet_s));
-    *tileset = (struct TileSet_s){NULL, NULL, NULL, NULL, NULL, 0, NULL};
+    if(!free_tilesets)
+        FillTileSetPool();
+    struct TileSet_s* tileset = free_tilesets;
+    free_tilesets = tileset->next_set;
+    *tileset = (struct TileSet_s){NULL, NULL, NULL, NULL, NULL, NULL, 0};
     return tileset;
 }
 
@@ -1892,58 +2505,33 @@ void PopTileFromTileSet(struct Tile_s** tile_head, struct Tile_s* tile)
     tile->tile_set->number--;
  } 
 
-struct Tile_s* PickTileFromSet(struct TileSet_s* tileset)
+struct Tile_s* PickTileFromSet(struct TileSet_s* tileset, struct Random_s* random)
 {
-    int index = rand()%(tileset->number);
-
-    // Pick the tile
-    struct Tile_s* cursor = tileset->tiles;
-    struct Tile_s* picked_tile;
-    // If first element
-    if(index == 0)
-    {
-        picked_tile = cursor;
-        tileset->tiles = cursor->next_tile;
-        tileset->number--;
-        picked_tile->next_tile = NULL;
-        return picked_tile;
-    }
-    // If last element
-    else if(index == tileset->number - 1)
-    {
-        for(int i = 0; i < index - 1; i++)
-        {
-            cursor = cursor->next_tile;
-        }
-        picked_tile = cursor->next_tile;
-        cursor->next_tile = NULL;
-        tileset->number--;
-        picked_tile->next_tile = NULL;
-        return picked_tile;
-    }
-    // If in the middle
-    else
-    {
-        for(int i = 0; i < index - 1; i++)
-        {
-            cursor = cursor->next_tile;
-        }
-        picked_tile = cursor->next_tile;
-        cursor->next_tile = cursor->next_tile->next_tile;
-        tileset->number--;
-        picked_tile->next_tile = NULL;
-        return picked_tile;
-    }
-
+    int index = GetRandomBelow(random, tileset->number);
+
+    // Unlink the tile from its neighbours
+    struct Tile_s** link = &tileset->tiles;
+    for(int i = 0; i < index; i++)
+        link = &(*link)->next_tile;
+    struct Tile_s* picked_tile = *link;
+    *link = picked_tile->next_tile;
+    if(picked_tile->next_tile)
+        picked_tile->next_tile->previous_tile = picked_tile->previous_tile;
+    if(tileset->last_tile == picked_tile)
+        tileset->last_tile = picked_tile->previous_tile;
+    tileset->number--;
+    picked_tile->next_tile = NULL;
+    picked_tile->previous_tile = NULL;
+    return picked_tile;
 }
 
-struct TileSet_s* CreatePlayerTileSet(struct TileSet_s* tileset)
+struct TileSet_s* CreatePlayerTileSet(struct TileSet_s* tileset, struct Random_s* random)
 {
     struct TileSet_s* player_tileset = CreateTilesSet();
 
-    for (int i = 0; i < 13; i++)
+    for (int i = 0; i < RACK_TILES; i++)
     {
-        AddTileToTileSet(&player_tileset, PickTileFromSet(tileset));
+        AddTileToTileSet(&player_tileset, PickTileFromSet(tileset, random));
     }
     
     return player_tileset;
@@ -2038,7 +2626,12 @@ void PrintTile(struct Tile_s* tile)
 {
     if(!tile)
         return;
-    switch (tile->color)
+    PrintTileNumberColor(tile->number, tile->color);
+}
+
+void PrintTileNumberColor(int number, char color)
+{
+    switch (color)
     {
     case 'R':
         printf("|\033[0;31m");
@@ -2055,7 +2648,7 @@ void PrintTile(struct Tile_s* tile)
     default:
         break;
     }
-    printf("%d", tile->number);
+    printf("%d", number);
     printf("\033[0;37m");
     printf("|");
 }
@@ -2105,3 +2698,4 @@ void PrintPlayerTileSet(struct TileSet_s* tileset)
 }
 
 
+